@@ -0,0 +1,71 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "client/capture_client.h"
+
+#include "sniffer/live_sniffer.h"
+
+namespace sniffer {
+namespace client {
+
+CaptureClient::CaptureClient(common::libev::IoLoop* server, sniffer::LiveSniffer* sniffer)
+    : common::libev::IoClient(server), sniffer_(sniffer), fd_(sniffer->GetSelectableFd()) {}
+
+common::Error CaptureClient::Write(const void* data, size_t size, size_t* nwrite_out) {
+  if (!data || !size || !nwrite_out) {
+    return common::make_error_inval();
+  }
+
+  NOTREACHED();
+  return common::Error();
+}
+
+common::Error CaptureClient::Read(unsigned char* out_data, size_t max_size, size_t* nread_out) {
+  if (!out_data || !max_size || !nread_out) {
+    return common::make_error_inval();
+  }
+
+  NOTREACHED();
+  return common::Error();
+}
+
+common::Error CaptureClient::Read(char* out_data, size_t max_size, size_t* nread_out) {
+  if (!out_data || !max_size || !nread_out) {
+    return common::make_error_inval();
+  }
+
+  NOTREACHED();
+  return common::Error();
+}
+
+common::Error CaptureClient::ReadPackets() {
+  return sniffer_->DispatchPending();
+}
+
+sniffer::LiveSniffer* CaptureClient::GetSniffer() const {
+  return sniffer_;
+}
+
+descriptor_t CaptureClient::GetFd() const {
+  return fd_;
+}
+
+common::Error CaptureClient::DoClose() {
+  // descriptor is closed with pcap handle
+  return common::Error();
+}
+
+}  // namespace client
+}
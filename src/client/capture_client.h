@@ -0,0 +1,50 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <common/libev/io_client.h>
+
+namespace sniffer {
+namespace sniffer {
+class LiveSniffer;
+}
+namespace client {
+
+// registers non-blocking pcap handle with loop, packets are drained on loop thread when readable
+class CaptureClient : public common::libev::IoClient {
+ public:
+  CaptureClient(common::libev::IoLoop* server, sniffer::LiveSniffer* sniffer);
+
+  virtual common::Error Write(const void* data, size_t size, size_t* nwrite_out) WARN_UNUSED_RESULT;
+
+  virtual common::Error Read(unsigned char* out_data, size_t max_size, size_t* nread_out) WARN_UNUSED_RESULT;
+  virtual common::Error Read(char* out_data, size_t max_size, size_t* nread_out) WARN_UNUSED_RESULT;
+
+  common::Error ReadPackets() WARN_UNUSED_RESULT;
+  sniffer::LiveSniffer* GetSniffer() const;
+
+ protected:  // executed IoLoop
+  virtual descriptor_t GetFd() const;
+
+ private:
+  virtual common::Error DoClose();
+
+  sniffer::LiveSniffer* sniffer_;  // not owned, pcap handle owns descriptor
+  const descriptor_t fd_;
+};
+
+}  // namespace client
+}
@@ -21,13 +21,74 @@
 
 #include "inih/ini.h"
 
+#include "client/entries_ring.h"
+#include "client/entry_spool.h"
+#include "client/uplink_window.h"
+
+#include "protocol/frame_codec.h"
+
+#include "sniffer/ring_sniffer.h"
+
 #define CONFIG_SERVER "server"
 #define CONFIG_SERVER_ID_FIELD "id"
 #define CONFIG_SERVER_DEVICE_FIELD "device"
+#define CONFIG_SERVER_CAPTURE_BACKEND_FIELD "capture_backend"
+#define CONFIG_SERVER_CAPTURE_PROFILE_FIELD "capture_profile"
+#define CONFIG_SERVER_CAPTURE_SNAPLEN_FIELD "capture_snaplen"
+#define CONFIG_SERVER_CAPTURE_BUFFER_SIZE_FIELD "capture_buffer_size"
+#define CONFIG_SERVER_CAPTURE_IMMEDIATE_FIELD "capture_immediate"
+#define CONFIG_SERVER_CAPTURE_BUSY_POLL_FIELD "capture_busy_poll"
+#define CONFIG_SERVER_CAPTURE_CPUS_FIELD "capture_cpus"
+#define CONFIG_SERVER_RING_BLOCK_SIZE_FIELD "ring_block_size"
+#define CONFIG_SERVER_RING_BLOCK_COUNT_FIELD "ring_block_count"
+#define CONFIG_SERVER_RING_RETIRE_TIMEOUT_FIELD "ring_retire_timeout"
+#define CONFIG_SERVER_FANOUT_WORKERS_FIELD "fanout_workers"
+#define CONFIG_SERVER_FANOUT_MODE_FIELD "fanout_mode"
+#define CONFIG_SERVER_FANOUT_GROUP_FIELD "fanout_group"
+#define CONFIG_SERVER_MAC_DENY_LIST_FIELD "mac_deny_list"
+#define CONFIG_SERVER_MAC_SKIP_LOCAL_FIELD "mac_skip_local"
+#define CONFIG_SERVER_MAC_FILTER_FILE_FIELD "mac_filter_file"
+#define CONFIG_SERVER_MAC_FILTER_MODE_FIELD "mac_filter_mode"
+#define CONFIG_SERVER_MAC_FILTER_BLOOM_FIELD "mac_filter_bloom"
+#define CONFIG_SERVER_FILTER_FIELD "filter"
+#define CONFIG_SERVER_REPLAY_FILE_FIELD "replay_file"
+#define CONFIG_SERVER_REPLAY_SPEED_FIELD "replay_speed"
+#define CONFIG_SERVER_AGGREGATE_ENTRIES_FIELD "aggregate_entries"
+#define CONFIG_SERVER_HANDOFF_CAPACITY_FIELD "handoff_capacity"
+
+#define CAPTURE_BACKEND_PCAP "pcap"
+#define CAPTURE_BACKEND_RING "ring"
+
+#define CAPTURE_PROFILE_DEFAULT "default"
+#define CAPTURE_PROFILE_THROUGHPUT "throughput"
+#define CAPTURE_PROFILE_LOW_LATENCY "low_latency"
+
+#define FANOUT_MODE_HASH "hash"
+#define FANOUT_MODE_CPU "cpu"
+
+#define MAC_FILTER_MODE_DENY "deny"
+#define MAC_FILTER_MODE_ALLOW "allow"
 
 #define CONFIG_MASTER "master"
 #define CONFIG_MASTER_NODE_HOST_FIELD "node_host"
 #define CONFIG_MASTER_NODE_LICENSE_KEY_FIELD "node_license_key"
+#define CONFIG_MASTER_SEND_STATS_FIELD "send_stats"
+#define CONFIG_MASTER_BATCH_SIZE_FIELD "batch_size"
+#define CONFIG_MASTER_BATCH_TIMEOUT_FIELD "batch_timeout"
+#define CONFIG_MASTER_BINARY_ENTRIES_FIELD "binary_entries"
+#define CONFIG_MASTER_COMPRESSION_FIELD "compression"
+#define CONFIG_MASTER_COMPRESSION_THRESHOLD_FIELD "compression_threshold"
+#define CONFIG_MASTER_COMPRESSION_DICTIONARY_FIELD "compression_dictionary"
+#define CONFIG_MASTER_UPLINK_WINDOW_FIELD "uplink_window"
+#define CONFIG_MASTER_PENDING_MAX_ENTRIES_FIELD "pending_max_entries"
+#define CONFIG_MASTER_ACK_TIMEOUT_FIELD "ack_timeout"
+#define CONFIG_MASTER_RECONNECT_INTERVAL_FIELD "reconnect_interval"
+#define CONFIG_MASTER_RECONNECT_MAX_INTERVAL_FIELD "reconnect_max_interval"
+#define CONFIG_MASTER_SPOOL_DIR_FIELD "spool_dir"
+#define CONFIG_MASTER_SPOOL_SEGMENT_SIZE_FIELD "spool_segment_size"
+#define CONFIG_MASTER_SPOOL_MAX_SIZE_FIELD "spool_max_size"
+#define CONFIG_MASTER_SPOOL_MAX_AGE_FIELD "spool_max_age"
+#define CONFIG_MASTER_SPOOL_REPLAY_RATE_FIELD "spool_replay_rate"
 
 #define DEFAULT_MASTER_NODE_PORT_FIELD 6317
 
@@ -36,16 +97,66 @@ const char kDefaultID[] = "localhost";
 const common::net::HostAndPort kDefaultMasterNodeHost =
     common::net::HostAndPort::CreateLocalHost(DEFAULT_MASTER_NODE_PORT_FIELD);
 const char kDefaultDevice[] = "eth0";
+const uint16_t kDefaultFanoutGroup = 6318;
 const char kDefaultMasterNodeLicenseKey[] = LICENSE_KEY;
+const size_t kDefaultBatchSize = 256;
+const uint32_t kDefaultBatchTimeout = 500;  // msec
+const size_t kDefaultPendingMaxEntries = 262144;
+const uint32_t kDefaultAckTimeout = 30;            // sec
+const uint32_t kDefaultReconnectInterval = 5;      // sec
+const uint32_t kDefaultReconnectMaxInterval = 60;  // sec
+const uint64_t kDefaultSpoolMaxSize = UINT64_C(256) * 1024 * 1024;
+const uint32_t kDefaultSpoolMaxAge = 24 * 3600;  // sec
+const uint32_t kDefaultSpoolReplayRate = 2000;   // entries per sec
 }
 /*
   [server]
   id=localhost
-  device=eth0
+  device=wlan0,wlan1
+  capture_backend=pcap
+  capture_profile=default
+  capture_snaplen=256
+  capture_buffer_size=67108864
+  capture_immediate=false
+  capture_busy_poll=50
+  capture_cpus=2,3
+  ring_block_size=4194304
+  ring_block_count=64
+  ring_retire_timeout=60
+  fanout_workers=0
+  fanout_mode=hash
+  fanout_group=6318
+  mac_deny_list=00:11:22:33:44:55,66:77:88:99:aa:bb
+  mac_skip_local=false
+  mac_filter_file=/etc/sniffer/access_points.txt
+  mac_filter_mode=deny
+  mac_filter_bloom=true
+  filter=
+  replay_file=
+  replay_speed=1
+  aggregate_entries=true
+  handoff_capacity=16384
 
   [master]
   node_host=localhost:6317
   node_license_key=0e4eb3ea92572a4ad627ad27e4a2c14d43a08a12ab25f8d288e33408f071dd0c
+  send_stats=false
+  batch_size=256
+  batch_timeout=500
+  binary_entries=true
+  compression=zstd
+  compression_threshold=1024
+  compression_dictionary=true
+  uplink_window=16
+  pending_max_entries=262144
+  ack_timeout=30
+  reconnect_interval=5
+  reconnect_max_interval=60
+  spool_dir=/var/spool/sniffer
+  spool_segment_size=4194304
+  spool_max_size=268435456
+  spool_max_age=86400
+  spool_replay_rate=2000
 */
 
 #define MATCH_FIELD(s, n) strcmp(section, s) == 0 && strcmp(name, n) == 0
@@ -53,13 +164,190 @@ const char kDefaultMasterNodeLicenseKey[] = LICENSE_KEY;
 namespace sniffer {
 namespace client {
 namespace {
+// comma separated list, "eth0, wlan0" is two items and empty items are skipped
+std::vector<std::string> SplitList(const char* value) {
+  std::vector<std::string> tokens;
+  common::Tokenize(value, ",", &tokens);
+  std::vector<std::string> result;
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    const std::string& token = tokens[i];
+    const size_t begin = token.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+      continue;
+    }
+    const size_t end = token.find_last_not_of(" \t");
+    result.push_back(token.substr(begin, end - begin + 1));
+  }
+  return result;
+}
+
 int ini_handler_fasto(void* user_data, const char* section, const char* name, const char* value) {
   Config* pconfig = reinterpret_cast<Config*>(user_data);
   if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_ID_FIELD)) {
     pconfig->server.id = value;
     return 1;
   } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_DEVICE_FIELD)) {
-    pconfig->server.device = value;
+    const std::vector<std::string> result = SplitList(value);
+    if (!result.empty()) {
+      pconfig->server.devices = result;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_CAPTURE_BACKEND_FIELD)) {
+    if (strcmp(value, CAPTURE_BACKEND_RING) == 0) {
+      pconfig->server.capture_backend = RING_CAPTURE;
+    } else if (strcmp(value, CAPTURE_BACKEND_PCAP) == 0) {
+      pconfig->server.capture_backend = PCAP_CAPTURE;
+    } else {
+      WARNING_LOG() << "Unknown capture backend: " << value;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_CAPTURE_PROFILE_FIELD)) {
+    if (strcmp(value, CAPTURE_PROFILE_DEFAULT) == 0) {
+      pconfig->server.capture.profile = PROFILE_DEFAULT;
+    } else if (strcmp(value, CAPTURE_PROFILE_THROUGHPUT) == 0) {
+      pconfig->server.capture.profile = PROFILE_THROUGHPUT;
+    } else if (strcmp(value, CAPTURE_PROFILE_LOW_LATENCY) == 0) {
+      pconfig->server.capture.profile = PROFILE_LOW_LATENCY;
+    } else {
+      WARNING_LOG() << "Unknown capture profile: " << value;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_CAPTURE_SNAPLEN_FIELD)) {
+    int snaplen;
+    if (common::ConvertFromString(value, &snaplen) && snaplen > 0) {
+      pconfig->server.capture.snaplen = snaplen;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_CAPTURE_BUFFER_SIZE_FIELD)) {
+    int buffer_size;
+    if (common::ConvertFromString(value, &buffer_size) && buffer_size >= 0) {
+      pconfig->server.capture.buffer_size = buffer_size;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_CAPTURE_IMMEDIATE_FIELD)) {
+    bool immediate;
+    if (common::ConvertFromString(value, &immediate)) {
+      pconfig->server.capture.immediate = immediate;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_CAPTURE_BUSY_POLL_FIELD)) {
+    int busy_poll;
+    if (common::ConvertFromString(value, &busy_poll) && busy_poll >= 0) {
+      pconfig->server.capture.busy_poll = busy_poll;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_CAPTURE_CPUS_FIELD)) {
+    const std::vector<std::string> result = SplitList(value);
+    std::vector<int> cpus;
+    for (size_t i = 0; i < result.size(); ++i) {
+      int cpu;
+      if (common::ConvertFromString(result[i], &cpu) && cpu >= 0) {
+        cpus.push_back(cpu);
+      } else {
+        WARNING_LOG() << "Invalid capture cpu: " << result[i];
+      }
+    }
+    pconfig->server.capture_cpus = cpus;
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_RING_BLOCK_SIZE_FIELD)) {
+    uint32_t block_size;
+    if (common::ConvertFromString(value, &block_size)) {
+      pconfig->server.ring.block_size = block_size;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_RING_BLOCK_COUNT_FIELD)) {
+    uint32_t block_count;
+    if (common::ConvertFromString(value, &block_count)) {
+      pconfig->server.ring.block_count = block_count;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_RING_RETIRE_TIMEOUT_FIELD)) {
+    uint32_t retire_timeout;
+    if (common::ConvertFromString(value, &retire_timeout)) {
+      pconfig->server.ring.retire_timeout = retire_timeout;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_FANOUT_WORKERS_FIELD)) {
+    uint32_t workers;
+    if (common::ConvertFromString(value, &workers)) {
+      pconfig->server.fanout.workers = workers;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_FANOUT_MODE_FIELD)) {
+    if (strcmp(value, FANOUT_MODE_HASH) == 0) {
+      pconfig->server.fanout.mode = FANOUT_HASH;
+    } else if (strcmp(value, FANOUT_MODE_CPU) == 0) {
+      pconfig->server.fanout.mode = FANOUT_CPU;
+    } else {
+      WARNING_LOG() << "Unknown fanout mode: " << value;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_FANOUT_GROUP_FIELD)) {
+    uint16_t group;
+    if (common::ConvertFromString(value, &group)) {
+      pconfig->server.fanout.group = group;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_MAC_DENY_LIST_FIELD)) {
+    const std::vector<std::string> result = SplitList(value);
+    std::vector<MacAddress> macs;
+    for (size_t i = 0; i < result.size(); ++i) {
+      MacAddress mac;
+      if (MacAddress::FromString(result[i], &mac)) {
+        macs.push_back(mac);
+      } else {
+        WARNING_LOG() << "Invalid mac address in deny list: " << result[i];
+      }
+    }
+    pconfig->server.mac_deny_list = macs;
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_MAC_SKIP_LOCAL_FIELD)) {
+    bool skip_local;
+    if (common::ConvertFromString(value, &skip_local)) {
+      pconfig->server.mac_skip_local = skip_local;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_MAC_FILTER_FILE_FIELD)) {
+    pconfig->server.mac_filter.path = value;
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_MAC_FILTER_MODE_FIELD)) {
+    if (strcmp(value, MAC_FILTER_MODE_DENY) == 0) {
+      pconfig->server.mac_filter.mode = MacFilter::DENY_LIST;
+    } else if (strcmp(value, MAC_FILTER_MODE_ALLOW) == 0) {
+      pconfig->server.mac_filter.mode = MacFilter::ALLOW_LIST;
+    } else {
+      WARNING_LOG() << "Unknown mac filter mode: " << value;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_MAC_FILTER_BLOOM_FIELD)) {
+    bool bloom;
+    if (common::ConvertFromString(value, &bloom)) {
+      pconfig->server.mac_filter.bloom = bloom;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_FILTER_FIELD)) {
+    pconfig->server.filter = value;
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_REPLAY_FILE_FIELD)) {
+    pconfig->server.replay_file = value;
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_REPLAY_SPEED_FIELD)) {
+    double speed;
+    if (common::ConvertFromString(value, &speed) && speed >= 0) {
+      pconfig->server.replay_speed = speed;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_AGGREGATE_ENTRIES_FIELD)) {
+    bool aggregate;
+    if (common::ConvertFromString(value, &aggregate)) {
+      pconfig->server.aggregate_entries = aggregate;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_HANDOFF_CAPACITY_FIELD)) {
+    size_t handoff_capacity;
+    if (common::ConvertFromString(value, &handoff_capacity) && handoff_capacity > 0) {
+      pconfig->server.handoff_capacity = handoff_capacity;
+    }
     return 1;
   } else if (MATCH_FIELD(CONFIG_MASTER, CONFIG_MASTER_NODE_HOST_FIELD)) {
     common::net::HostAndPort hs;
@@ -70,15 +358,161 @@ int ini_handler_fasto(void* user_data, const char* section, const char* name, co
   } else if (MATCH_FIELD(CONFIG_MASTER, CONFIG_MASTER_NODE_LICENSE_KEY_FIELD)) {
     pconfig->master.node_license_key = value;
     return 1;
+  } else if (MATCH_FIELD(CONFIG_MASTER, CONFIG_MASTER_SEND_STATS_FIELD)) {
+    bool send_stats;
+    if (common::ConvertFromString(value, &send_stats)) {
+      pconfig->master.send_stats = send_stats;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_MASTER, CONFIG_MASTER_BATCH_SIZE_FIELD)) {
+    size_t batch_size;
+    if (common::ConvertFromString(value, &batch_size) && batch_size > 0) {
+      pconfig->master.batch_size = batch_size;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_MASTER, CONFIG_MASTER_BATCH_TIMEOUT_FIELD)) {
+    uint32_t batch_timeout;
+    if (common::ConvertFromString(value, &batch_timeout) && batch_timeout > 0) {
+      pconfig->master.batch_timeout = batch_timeout;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_MASTER, CONFIG_MASTER_BINARY_ENTRIES_FIELD)) {
+    bool binary_entries;
+    if (common::ConvertFromString(value, &binary_entries)) {
+      pconfig->master.binary_entries = binary_entries;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_MASTER, CONFIG_MASTER_COMPRESSION_FIELD)) {
+    if (strcmp(value, FRAME_COMPRESSION_ZSTD) == 0) {
+      pconfig->master.compression = true;
+    } else if (strcmp(value, FRAME_COMPRESSION_NONE) == 0) {
+      pconfig->master.compression = false;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_MASTER, CONFIG_MASTER_COMPRESSION_THRESHOLD_FIELD)) {
+    size_t compression_threshold;
+    if (common::ConvertFromString(value, &compression_threshold)) {
+      pconfig->master.compression_threshold = compression_threshold;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_MASTER, CONFIG_MASTER_COMPRESSION_DICTIONARY_FIELD)) {
+    bool compression_dictionary;
+    if (common::ConvertFromString(value, &compression_dictionary)) {
+      pconfig->master.compression_dictionary = compression_dictionary;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_MASTER, CONFIG_MASTER_UPLINK_WINDOW_FIELD)) {
+    size_t uplink_window;
+    if (common::ConvertFromString(value, &uplink_window) && uplink_window > 0) {
+      pconfig->master.uplink_window = uplink_window;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_MASTER, CONFIG_MASTER_PENDING_MAX_ENTRIES_FIELD)) {
+    size_t pending_max_entries;
+    if (common::ConvertFromString(value, &pending_max_entries) && pending_max_entries > 0) {
+      pconfig->master.pending_max_entries = pending_max_entries;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_MASTER, CONFIG_MASTER_ACK_TIMEOUT_FIELD)) {
+    uint32_t ack_timeout;
+    if (common::ConvertFromString(value, &ack_timeout) && ack_timeout > 0) {
+      pconfig->master.ack_timeout = ack_timeout;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_MASTER, CONFIG_MASTER_RECONNECT_INTERVAL_FIELD)) {
+    uint32_t reconnect_interval;
+    if (common::ConvertFromString(value, &reconnect_interval)) {
+      pconfig->master.reconnect_interval = reconnect_interval;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_MASTER, CONFIG_MASTER_RECONNECT_MAX_INTERVAL_FIELD)) {
+    uint32_t reconnect_max_interval;
+    if (common::ConvertFromString(value, &reconnect_max_interval) && reconnect_max_interval > 0) {
+      pconfig->master.reconnect_max_interval = reconnect_max_interval;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_MASTER, CONFIG_MASTER_SPOOL_DIR_FIELD)) {
+    pconfig->master.spool_dir = value;
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_MASTER, CONFIG_MASTER_SPOOL_SEGMENT_SIZE_FIELD)) {
+    size_t spool_segment_size;
+    if (common::ConvertFromString(value, &spool_segment_size) && spool_segment_size > 0) {
+      pconfig->master.spool_segment_size = spool_segment_size;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_MASTER, CONFIG_MASTER_SPOOL_MAX_SIZE_FIELD)) {
+    uint64_t spool_max_size;
+    if (common::ConvertFromString(value, &spool_max_size) && spool_max_size > 0) {
+      pconfig->master.spool_max_size = spool_max_size;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_MASTER, CONFIG_MASTER_SPOOL_MAX_AGE_FIELD)) {
+    uint32_t spool_max_age;
+    if (common::ConvertFromString(value, &spool_max_age) && spool_max_age > 0) {
+      pconfig->master.spool_max_age = spool_max_age;
+    }
+    return 1;
+  } else if (MATCH_FIELD(CONFIG_MASTER, CONFIG_MASTER_SPOOL_REPLAY_RATE_FIELD)) {
+    uint32_t spool_replay_rate;
+    if (common::ConvertFromString(value, &spool_replay_rate) && spool_replay_rate > 0) {
+      pconfig->master.spool_replay_rate = spool_replay_rate;
+    }
+    return 1;
   } else {
     return 0; /* unknown section/name, error */
   }
 }
 }  // namespace
 
-ServerSettings::ServerSettings() : id(kDefaultID), device(kDefaultDevice) {}
+CaptureSettings::CaptureSettings()
+    : profile(PROFILE_DEFAULT), snaplen(-1), buffer_size(-1), immediate(-1), busy_poll(-1) {}
+
+RingSettings::RingSettings()
+    : block_size(sniffer::RingSniffer::default_block_size),
+      block_count(sniffer::RingSniffer::default_block_count),
+      retire_timeout(sniffer::RingSniffer::default_retire_timeout) {}
+
+FanoutSettings::FanoutSettings() : workers(0), mode(FANOUT_HASH), group(kDefaultFanoutGroup) {}
+
+MacFilterSettings::MacFilterSettings() : path(), mode(MacFilter::DENY_LIST), bloom(true) {}
+
+ServerSettings::ServerSettings()
+    : id(kDefaultID),
+      devices({kDefaultDevice}),
+      capture_cpus(),
+      capture_backend(PCAP_CAPTURE),
+      capture(),
+      ring(),
+      fanout(),
+      mac_deny_list(),
+      mac_skip_local(false),
+      mac_filter(),
+      filter(),
+      replay_file(),
+      replay_speed(1),
+      aggregate_entries(true),
+      handoff_capacity(EntriesRing::default_capacity) {}
 
-MasterSettings::MasterSettings() : node_host(kDefaultMasterNodeHost), node_license_key(kDefaultMasterNodeLicenseKey) {}
+MasterSettings::MasterSettings()
+    : node_host(kDefaultMasterNodeHost),
+      node_license_key(kDefaultMasterNodeLicenseKey),
+      send_stats(false),
+      batch_size(kDefaultBatchSize),
+      batch_timeout(kDefaultBatchTimeout),
+      binary_entries(true),
+      compression(true),
+      compression_threshold(protocol::FrameCodec::default_threshold),
+      compression_dictionary(true),
+      uplink_window(UplinkWindow::default_max_batches),
+      pending_max_entries(kDefaultPendingMaxEntries),
+      ack_timeout(kDefaultAckTimeout),
+      reconnect_interval(kDefaultReconnectInterval),
+      reconnect_max_interval(kDefaultReconnectMaxInterval),
+      spool_dir(),
+      spool_segment_size(EntrySpool::default_segment_size),
+      spool_max_size(kDefaultSpoolMaxSize),
+      spool_max_age(kDefaultSpoolMaxAge),
+      spool_replay_rate(kDefaultSpoolReplayRate) {}
 
 Config::Config() : server() {}
 
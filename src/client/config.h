@@ -15,19 +15,76 @@
 #pragma once
 
 #include <string>  // for string
+#include <vector>
 
 #include <common/error.h>      // for Error
 #include <common/macros.h>     // for WARN_UNUSED_RESULT
 #include <common/net/types.h>  // for HostAndPort
 #include <common/file_system/path.h>
 
+#include "mac_filter.h"
+#include "types.h"
+
 namespace sniffer {
 namespace client {
 
+enum CaptureBackend { PCAP_CAPTURE = 0, RING_CAPTURE };
+enum FanoutMode { FANOUT_HASH = 0, FANOUT_CPU };
+enum CaptureProfile { PROFILE_DEFAULT = 0, PROFILE_THROUGHPUT, PROFILE_LOW_LATENCY };
+
+struct RingSettings {
+  RingSettings();
+
+  uint32_t block_size;
+  uint32_t block_count;
+  uint32_t retire_timeout;  // msec
+};
+
+struct FanoutSettings {
+  FanoutSettings();
+
+  uint32_t workers;  // 0 or 1 - fanout disabled
+  FanoutMode mode;
+  uint16_t group;
+};
+
+// pcap backend tuning, overrides are -1 when taken from profile
+struct CaptureSettings {
+  CaptureSettings();
+
+  CaptureProfile profile;
+  int snaplen;
+  int buffer_size;
+  int immediate;
+  int busy_poll;  // usec
+};
+
+// large address lists matched in parser, file is reloaded when changed
+struct MacFilterSettings {
+  MacFilterSettings();
+
+  std::string path;  // empty - no filter
+  MacFilter::Mode mode;
+  bool bloom;
+};
+
 struct ServerSettings {
   ServerSettings();
   std::string id;
-  std::string device;
+  std::vector<std::string> devices;  // one or more capture interfaces
+  std::vector<int> capture_cpus;     // worker thread i is pinned to capture_cpus[i % size], empty - round robin
+  CaptureBackend capture_backend;
+  CaptureSettings capture;
+  RingSettings ring;
+  FanoutSettings fanout;
+  std::vector<MacAddress> mac_deny_list;  // compiled into capture filter, keep short
+  bool mac_skip_local;  // drop locally administered (randomized) addresses
+  MacFilterSettings mac_filter;
+  std::string filter;  // empty - generated from parser rules and mac_deny_list
+  std::string replay_file;  // not empty - packets are replayed from capture file instead of device
+  double replay_speed;      // 1 - original timing, N - N times faster, 0 - as fast as possible
+  bool aggregate_entries;   // one entry per transmitter and second instead of one per frame
+  size_t handoff_capacity;  // entries queued from each capture worker to loop thread
 };
 
 struct MasterSettings {
@@ -35,6 +92,23 @@ struct MasterSettings {
 
   common::net::HostAndPort node_host;
   std::string node_license_key;
+  bool send_stats;  // forward sampled capture statistics to master
+  size_t batch_size;                // entries per SLAVE_SEND_ENTRIES request, 1 - one SLAVE_SEND_ENTRY per entry
+  uint32_t batch_timeout;           // msec, partial batch is sent after it
+  bool binary_entries;              // offer compact entries on activation, json is kept if master declines
+  bool compression;                 // offer zstd frames on activation
+  size_t compression_threshold;     // bytes, smaller commands are sent raw
+  bool compression_dictionary;      // train dictionary on first compressed commands
+  size_t uplink_window;             // entries requests sent without ack, capture is held back when reached
+  size_t pending_max_entries;       // queued in memory behind full window, oldest go to spool or dropped above it
+  uint32_t ack_timeout;             // sec, connection without ack for oldest request is reopened
+  uint32_t reconnect_interval;      // sec, first retry delay, doubled after each failure, 0 - connect only on start
+  uint32_t reconnect_max_interval;  // sec, cap of retry delay
+  std::string spool_dir;            // entries are kept here while master is unreachable, empty - dropped
+  size_t spool_segment_size;        // bytes per spool file
+  uint64_t spool_max_size;          // bytes, oldest entries are dropped above it
+  uint32_t spool_max_age;           // sec, older spool files are dropped
+  uint32_t spool_replay_rate;       // spooled entries per second sent after reconnect
 };
 
 struct Config {
@@ -0,0 +1,93 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "client/entries_ring.h"
+
+#include <utility>
+
+namespace sniffer {
+namespace client {
+namespace {
+size_t RoundUpPowerOfTwo(size_t value) {
+  size_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+}  // namespace
+
+EntriesRing::EntriesRing(size_t capacity)
+    : mask_(RoundUpPowerOfTwo(capacity ? capacity : 1) - 1),
+      slots_(mask_ + 1),
+      pad0_(),
+      head_(0),
+      cached_tail_(0),
+      high_water_(0),
+      dropped_(0),
+      pad1_(),
+      tail_(0),
+      pad2_() {}
+
+size_t EntriesRing::Push(const EntryInfo* entries, size_t count) {
+  const size_t head = head_.load(std::memory_order_relaxed);
+  const size_t capacity = mask_ + 1;
+  if (head - cached_tail_ + count > capacity) {
+    cached_tail_ = tail_.load(std::memory_order_acquire);
+  }
+
+  const size_t free_slots = capacity - (head - cached_tail_);
+  const size_t pushed = count < free_slots ? count : free_slots;
+  for (size_t i = 0; i < pushed; ++i) {
+    slots_[(head + i) & mask_] = entries[i];
+  }
+  head_.store(head + pushed, std::memory_order_release);
+
+  if (pushed != count) {
+    dropped_.fetch_add(count - pushed, std::memory_order_relaxed);
+  }
+  // one load per batch keeps the metric exact, stale cached_tail_ would report near capacity
+  cached_tail_ = tail_.load(std::memory_order_acquire);
+  const size_t used = head + pushed - cached_tail_;
+  if (used > high_water_.load(std::memory_order_relaxed)) {
+    high_water_.store(used, std::memory_order_relaxed);  // single writer
+  }
+  return pushed;
+}
+
+size_t EntriesRing::Pop(std::vector<EntryInfo>* out) {
+  const size_t tail = tail_.load(std::memory_order_relaxed);
+  const size_t head = head_.load(std::memory_order_acquire);
+  for (size_t i = tail; i != head; ++i) {
+    out->push_back(std::move(slots_[i & mask_]));
+  }
+  tail_.store(head, std::memory_order_release);
+  return head - tail;
+}
+
+size_t EntriesRing::GetCapacity() const {
+  return mask_ + 1;
+}
+
+size_t EntriesRing::GetHighWater() const {
+  return high_water_.load(std::memory_order_relaxed);
+}
+
+uint64_t EntriesRing::GetDropped() const {
+  return dropped_.load(std::memory_order_relaxed);
+}
+
+}  // namespace client
+}  // namespace sniffer
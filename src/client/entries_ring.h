@@ -0,0 +1,64 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include <common/macros.h>
+
+#include "entry_info.h"
+
+namespace sniffer {
+namespace client {
+
+// bounded queue of parsed entries from one capture worker to loop thread,
+// producer and consumer indexes live on own cache lines
+class EntriesRing {
+ public:
+  enum { default_capacity = 16384, cache_line_size = 64 };
+
+  explicit EntriesRing(size_t capacity);  // rounded up to power of two
+
+  // capture worker, entries which don't fit are dropped, returns pushed count
+  size_t Push(const EntryInfo* entries, size_t count);
+
+  // loop thread, appends entries pushed so far
+  size_t Pop(std::vector<EntryInfo>* out);
+
+  size_t GetCapacity() const;
+  size_t GetHighWater() const;  // max entries waiting for loop thread
+  uint64_t GetDropped() const;  // entries lost because ring was full
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(EntriesRing);
+
+  const size_t mask_;
+  std::vector<EntryInfo> slots_;
+
+  char pad0_[cache_line_size];
+  std::atomic<size_t> head_;  // next slot to write, stored by producer
+  size_t cached_tail_;        // producer's view of tail_, refreshed after each push and when ring looks full
+  std::atomic<size_t> high_water_;
+  std::atomic<uint64_t> dropped_;
+
+  char pad1_[cache_line_size];
+  std::atomic<size_t> tail_;  // next slot to read, stored by consumer
+  char pad2_[cache_line_size];
+};
+
+}  // namespace client
+}  // namespace sniffer
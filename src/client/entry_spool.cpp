@@ -0,0 +1,390 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "client/entry_spool.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include <common/logger.h>
+#include <common/sprintf.h>
+#include <common/time.h>
+
+#define SPOOL_SEGMENT_MAGIC "SNFSPOL1"
+#define SPOOL_SEGMENT_SUFFIX ".seg"
+
+namespace sniffer {
+namespace client {
+namespace {
+
+struct SpoolHeader {
+  char magic[8];
+  uint32_t record_size;
+  uint32_t reserved;
+  int64_t created_msec;
+  uint64_t read_records;  // replay cursor, survives restart
+  char padding[32];
+};
+
+// zero checksum marks free slot, preallocated segment file is zero filled
+struct SpoolRecord {
+  uint32_t checksum;
+  uint8_t iface_len;
+  int8_t ssi;
+  int8_t ssi_min;
+  int8_t ssi_max;
+  uint64_t mac;
+  int64_t timestamp;
+  uint32_t count;
+  uint32_t reserved;
+  char iface[16];  // IFNAMSIZ
+};
+
+static_assert(sizeof(SpoolHeader) == 64, "Spool header layout changed");
+static_assert(sizeof(SpoolRecord) == 48, "Spool record layout changed");
+
+uint32_t RecordChecksum(const SpoolRecord& record) {
+  // fnv-1a over everything after checksum field
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&record) + sizeof(record.checksum);
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < sizeof(SpoolRecord) - sizeof(record.checksum); ++i) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash ? hash : 1;
+}
+
+bool ParseSegmentName(const char* name, uint64_t* seq) {
+  const size_t len = strlen(name);
+  const size_t suffix_len = sizeof(SPOOL_SEGMENT_SUFFIX) - 1;
+  if (len <= suffix_len || strcmp(name + len - suffix_len, SPOOL_SEGMENT_SUFFIX) != 0) {
+    return false;
+  }
+
+  char* end = nullptr;
+  *seq = strtoull(name, &end, 10);
+  return end == name + len - suffix_len;
+}
+
+}  // namespace
+
+struct EntrySpool::Segment {
+  std::string path;
+  uint64_t seq;
+  int fd;
+  uint8_t* data;
+  size_t size;
+  uint64_t capacity;  // records
+  uint64_t written;   // valid records from start
+
+  SpoolHeader* GetHeader() const { return reinterpret_cast<SpoolHeader*>(data); }
+  SpoolRecord* GetRecord(uint64_t index) const {
+    return reinterpret_cast<SpoolRecord*>(data + sizeof(SpoolHeader)) + index;
+  }
+};
+
+EntrySpool::EntrySpool(const std::string& dir,
+                       size_t segment_size,
+                       uint64_t max_size,
+                       common::time64_t max_age_msec)
+    : dir_(dir),
+      segment_size_(std::max(segment_size, sizeof(SpoolHeader) + sizeof(SpoolRecord))),
+      max_size_(max_size),
+      max_age_msec_(max_age_msec),
+      segments_(),
+      next_seq_(0),
+      pending_(0),
+      dropped_(0) {}
+
+EntrySpool::~EntrySpool() {
+  Close();
+}
+
+common::Error EntrySpool::Open() {
+  DCHECK(segments_.empty());
+  if (mkdir(dir_.c_str(), 0755) != 0 && errno != EEXIST) {
+    return common::make_error(common::MemSPrintf("error creating spool directory: %s, errno: %d", dir_.c_str(), errno));
+  }
+
+  DIR* dir = opendir(dir_.c_str());
+  if (!dir) {
+    return common::make_error(common::MemSPrintf("error opening spool directory: %s, errno: %d", dir_.c_str(), errno));
+  }
+
+  std::vector<uint64_t> seqs;
+  while (struct dirent* ent = readdir(dir)) {
+    uint64_t seq;
+    if (ParseSegmentName(ent->d_name, &seq)) {
+      seqs.push_back(seq);
+    }
+  }
+  closedir(dir);
+  std::sort(seqs.begin(), seqs.end());
+
+  for (size_t i = 0; i < seqs.size(); ++i) {
+    const std::string path = GetSegmentPath(seqs[i]);
+    common::Error err = OpenSegment(path, seqs[i]);
+    if (err) {
+      WARNING_LOG() << "Drop unreadable spool segment: " << path << ", error: " << err->GetDescription();
+      unlink(path.c_str());
+    }
+    next_seq_ = seqs[i] + 1;
+  }
+
+  // segments replayed before restart
+  while (segments_.size() > 1 && segments_.front()->GetHeader()->read_records == segments_.front()->written) {
+    DropOldestSegment();
+  }
+  return common::Error();
+}
+
+void EntrySpool::Close() {
+  for (Segment* segment : segments_) {
+    munmap(segment->data, segment->size);
+    close(segment->fd);
+    delete segment;
+  }
+  segments_.clear();
+  pending_ = 0;
+}
+
+common::Error EntrySpool::OpenSegment(const std::string& path, uint64_t seq) {
+  int fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+  if (fd == -1) {
+    return common::make_error(common::MemSPrintf("open failed, errno: %d", errno));
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SpoolHeader) + sizeof(SpoolRecord)) {
+    close(fd);
+    return common::make_error("segment is truncated");
+  }
+
+  const size_t size = st.st_size;
+  void* data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    close(fd);
+    return common::make_error(common::MemSPrintf("mmap failed, errno: %d", errno));
+  }
+
+  Segment* segment = new Segment;
+  segment->path = path;
+  segment->seq = seq;
+  segment->fd = fd;
+  segment->data = static_cast<uint8_t*>(data);
+  segment->size = size;
+  segment->capacity = (size - sizeof(SpoolHeader)) / sizeof(SpoolRecord);
+  segment->written = 0;
+
+  SpoolHeader* header = segment->GetHeader();
+  if (memcmp(header->magic, SPOOL_SEGMENT_MAGIC, sizeof(header->magic)) != 0 ||
+      header->record_size != sizeof(SpoolRecord)) {
+    munmap(data, size);
+    close(fd);
+    delete segment;
+    return common::make_error("invalid segment header");
+  }
+
+  // records after crash end at first slot which is empty or torn
+  while (segment->written < segment->capacity) {
+    const SpoolRecord* record = segment->GetRecord(segment->written);
+    if (!record->checksum || record->checksum != RecordChecksum(*record)) {
+      break;
+    }
+    segment->written++;
+  }
+  // complete records of crashed run behind torn one would be revived once appends reach them, torn one may
+  // have zero checksum and pages may reach disk out of order, so every slot up to the end is checked
+  static const SpoolRecord kFreeRecord = SpoolRecord();
+  for (uint64_t i = segment->written; i < segment->capacity; ++i) {
+    SpoolRecord* record = segment->GetRecord(i);
+    if (memcmp(record, &kFreeRecord, sizeof(SpoolRecord)) != 0) {
+      memset(record, 0, sizeof(SpoolRecord));
+    }
+  }
+  header->read_records = std::min(header->read_records, segment->written);
+
+  pending_ += segment->written - header->read_records;
+  segments_.push_back(segment);
+  return common::Error();
+}
+
+common::Error EntrySpool::CreateSegment() {
+  // size cap is kept by dropping oldest, unreplayed entries, new one is always written
+  while (!segments_.empty() && GetSize() + segment_size_ > max_size_) {
+    dropped_ += DropOldestSegment();
+  }
+
+  const uint64_t seq = next_seq_++;
+  const std::string path = GetSegmentPath(seq);
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+  if (fd == -1) {
+    return common::make_error(common::MemSPrintf("error creating spool segment: %s, errno: %d", path.c_str(), errno));
+  }
+
+  if (ftruncate(fd, segment_size_) != 0) {
+    close(fd);
+    unlink(path.c_str());
+    return common::make_error(common::MemSPrintf("error sizing spool segment: %s, errno: %d", path.c_str(), errno));
+  }
+
+  void* data = mmap(NULL, segment_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    close(fd);
+    unlink(path.c_str());
+    return common::make_error(common::MemSPrintf("error mapping spool segment: %s, errno: %d", path.c_str(), errno));
+  }
+
+  Segment* segment = new Segment;
+  segment->path = path;
+  segment->seq = seq;
+  segment->fd = fd;
+  segment->data = static_cast<uint8_t*>(data);
+  segment->size = segment_size_;
+  segment->capacity = (segment_size_ - sizeof(SpoolHeader)) / sizeof(SpoolRecord);
+  segment->written = 0;
+
+  SpoolHeader* header = segment->GetHeader();
+  memcpy(header->magic, SPOOL_SEGMENT_MAGIC, sizeof(header->magic));
+  header->record_size = sizeof(SpoolRecord);
+  header->created_msec = common::time::current_mstime();
+  header->read_records = 0;
+  segments_.push_back(segment);
+  return common::Error();
+}
+
+uint64_t EntrySpool::DropOldestSegment() {
+  DCHECK(!segments_.empty());
+  Segment* segment = segments_.front();
+  segments_.pop_front();
+
+  const uint64_t unread = segment->written - segment->GetHeader()->read_records;
+  pending_ -= unread;
+  munmap(segment->data, segment->size);
+  close(segment->fd);
+  unlink(segment->path.c_str());
+  delete segment;
+  return unread;
+}
+
+common::Error EntrySpool::Append(const EntryInfo* entries, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    if (segments_.empty() || segments_.back()->written == segments_.back()->capacity) {
+      common::Error err = CreateSegment();
+      if (err) {
+        dropped_ += count - i;
+        return err;
+      }
+    }
+
+    const EntryInfo& ent = entries[i];
+    const std::string iface = ent.GetIface();
+    SpoolRecord record;
+    memset(&record, 0, sizeof(record));
+    record.iface_len = std::min(iface.size(), sizeof(record.iface));
+    record.ssi = ent.GetSSI();
+    record.ssi_min = ent.GetMinSSI();
+    record.ssi_max = ent.GetMaxSSI();
+    record.mac = ent.GetMacAddress().GetValue();
+    record.timestamp = ent.GetTimestamp();
+    record.count = ent.GetCount();
+    memcpy(record.iface, iface.data(), record.iface_len);
+    record.checksum = RecordChecksum(record);
+
+    Segment* segment = segments_.back();
+    memcpy(segment->GetRecord(segment->written), &record, sizeof(record));
+    segment->written++;
+    pending_++;
+  }
+  return common::Error();
+}
+
+size_t EntrySpool::Read(size_t max_count, std::vector<EntryInfo>* entries) {
+  size_t read = 0;
+  while (read < max_count && !segments_.empty()) {
+    Segment* segment = segments_.front();
+    SpoolHeader* header = segment->GetHeader();
+    if (header->read_records == segment->written) {
+      // appended segment is kept until it is full
+      if (segments_.size() == 1 && segment->written < segment->capacity) {
+        break;
+      }
+      DropOldestSegment();
+      continue;
+    }
+
+    const uint64_t end = std::min<uint64_t>(segment->written, header->read_records + (max_count - read));
+    for (uint64_t i = header->read_records; i < end; ++i) {
+      const SpoolRecord* record = segment->GetRecord(i);
+      EntryInfo ent(MacAddress::FromValue(record->mac), record->timestamp, record->ssi);
+      ent.SetAggregate(record->count, record->ssi_min, record->ssi_max);
+      ent.SetIface(std::string(record->iface, record->iface_len));
+      entries->push_back(ent);
+    }
+
+    read += end - header->read_records;
+    pending_ -= end - header->read_records;
+    header->read_records = end;
+  }
+  return read;
+}
+
+void EntrySpool::Expire(common::time64_t now_msec) {
+  while (segments_.size() > 1 && now_msec - segments_.front()->GetHeader()->created_msec > max_age_msec_) {
+    dropped_ += DropOldestSegment();
+  }
+}
+
+void EntrySpool::Sync() {
+  // pages of MAP_SHARED mapping outlive process crash, this schedules them for disk
+  if (!segments_.empty()) {
+    msync(segments_.front()->data, segments_.front()->size, MS_ASYNC);
+    msync(segments_.back()->data, segments_.back()->size, MS_ASYNC);
+  }
+}
+
+bool EntrySpool::IsEmpty() const {
+  return pending_ == 0;
+}
+
+uint64_t EntrySpool::GetPendingCount() const {
+  return pending_;
+}
+
+uint64_t EntrySpool::GetSize() const {
+  uint64_t size = 0;
+  for (const Segment* segment : segments_) {
+    size += segment->size;
+  }
+  return size;
+}
+
+uint64_t EntrySpool::GetDroppedCount() const {
+  return dropped_;
+}
+
+std::string EntrySpool::GetSegmentPath(uint64_t seq) const {
+  return dir_ + "/" + common::MemSPrintf("%020llu", static_cast<unsigned long long>(seq)) + SPOOL_SEGMENT_SUFFIX;
+}
+
+}  // namespace client
+}  // namespace sniffer
@@ -0,0 +1,78 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <common/error.h>
+#include <common/macros.h>
+#include <common/types.h>
+
+#include "entry_info.h"
+
+namespace sniffer {
+namespace client {
+
+// append only store of entries not delivered to master, kept in fixed size mmap segments of spool directory,
+// records carry checksum so segments left by crash are recovered up to first torn record
+class EntrySpool {
+ public:
+  enum { default_segment_size = 4 * 1024 * 1024 };
+
+  EntrySpool(const std::string& dir, size_t segment_size, uint64_t max_size, common::time64_t max_age_msec);
+  ~EntrySpool();
+
+  common::Error Open() WARN_UNUSED_RESULT;  // creates directory, recovers segments of previous run
+  void Close();
+
+  // oldest segments are dropped when size cap is reached
+  common::Error Append(const EntryInfo* entries, size_t count) WARN_UNUSED_RESULT;
+  // oldest first, read entries are not returned again, also after restart
+  size_t Read(size_t max_count, std::vector<EntryInfo>* entries);
+
+  void Expire(common::time64_t now_msec);  // drops segments created earlier than age cap
+  void Sync();                             // writes dirty pages of open segments to disk
+
+  bool IsEmpty() const;
+  uint64_t GetPendingCount() const;  // appended and not yet read
+  uint64_t GetSize() const;          // bytes of segment files
+  uint64_t GetDroppedCount() const;  // lost to size and age caps
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(EntrySpool);
+
+  struct Segment;
+
+  common::Error OpenSegment(const std::string& path, uint64_t seq);
+  common::Error CreateSegment();
+  uint64_t DropOldestSegment();  // returns unread entries removed with it
+  std::string GetSegmentPath(uint64_t seq) const;
+
+  const std::string dir_;
+  const size_t segment_size_;
+  const uint64_t max_size_;
+  const common::time64_t max_age_msec_;
+
+  std::deque<Segment*> segments_;  // oldest first, last one is appended
+  uint64_t next_seq_;
+  uint64_t pending_;
+  uint64_t dropped_;
+};
+
+}  // namespace client
+}  // namespace sniffer
@@ -0,0 +1,73 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "client/handoff_client.h"
+
+#include <errno.h>
+#include <unistd.h>
+
+namespace sniffer {
+namespace client {
+
+HandoffClient::HandoffClient(common::libev::IoLoop* server, descriptor_t event_fd)
+    : common::libev::IoClient(server), fd_(event_fd) {}
+
+common::Error HandoffClient::Write(const void* data, size_t size, size_t* nwrite_out) {
+  if (!data || !size || !nwrite_out) {
+    return common::make_error_inval();
+  }
+
+  NOTREACHED();
+  return common::Error();
+}
+
+common::Error HandoffClient::Read(unsigned char* out_data, size_t max_size, size_t* nread_out) {
+  if (!out_data || !max_size || !nread_out) {
+    return common::make_error_inval();
+  }
+
+  NOTREACHED();
+  return common::Error();
+}
+
+common::Error HandoffClient::Read(char* out_data, size_t max_size, size_t* nread_out) {
+  if (!out_data || !max_size || !nread_out) {
+    return common::make_error_inval();
+  }
+
+  NOTREACHED();
+  return common::Error();
+}
+
+common::Error HandoffClient::ClearWakeups() {
+  uint64_t wakeups;
+  if (read(fd_, &wakeups, sizeof(wakeups)) < 0 && errno != EAGAIN) {
+    common::ErrnoError errn = common::make_errno_error(errno);
+    return common::make_error_from_errno(errn);
+  }
+  return common::Error();
+}
+
+descriptor_t HandoffClient::GetFd() const {
+  return fd_;
+}
+
+common::Error HandoffClient::DoClose() {
+  // descriptor outlives loop, workers may still signal it until joined
+  return common::Error();
+}
+
+}  // namespace client
+}  // namespace sniffer
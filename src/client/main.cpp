@@ -28,14 +28,15 @@
 
 #include "client/sniffer_service.h"
 
-#define HELP_TEXT                          \
-  "Usage: " SERVICE_NAME                   \
-  " [options]\n"                           \
-  "  Manipulate " SERVICE_NAME             \
-  ".\n\n"                                  \
-  "    --version  display version\n"       \
-  "    --daemon   run as a daemon\n"       \
-  "    --stop     stop running instance\n" \
+#define HELP_TEXT                                                 \
+  "Usage: " SERVICE_NAME                                          \
+  " [options]\n"                                                  \
+  "  Manipulate " SERVICE_NAME                                    \
+  ".\n\n"                                                         \
+  "    --version  display version\n"                              \
+  "    --daemon   run as a daemon\n"                              \
+  "    --stop     stop running instance\n"                        \
+  "    --stats    print capture statistics of running instance\n" \
   "    --reload   force running instance to reread configuration file\n"
 
 namespace {
@@ -86,6 +87,14 @@ int main(int argc, char** argv, char** envp) {
 
       return sniffer::client::SnifferService::SendStopDaemonRequest(
           license_key, sniffer::client::SnifferService::GetServerHostAndPort());
+    } else if (strcmp(argv[i], "--stats") == 0) {
+      std::string license_key;
+      if (!create_license_key(&license_key)) {
+        return EXIT_FAILURE;
+      }
+
+      return sniffer::client::SnifferService::SendGetStatsRequest(
+          license_key, sniffer::client::SnifferService::GetServerHostAndPort());
     } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
       std::cout << HELP_TEXT << std::endl;
       return EXIT_SUCCESS;
@@ -0,0 +1,97 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "client/sightings_aggregator.h"
+
+#include <algorithm>
+
+namespace sniffer {
+namespace client {
+
+SightingsAggregator::Sighting::Sighting() : count(0), ssi_count(0), ssi_sum(0), ssi_min(0), ssi_max(0) {}
+
+SightingsAggregator::SightingsAggregator() : seconds_(), newest_(0), ifaces_(), added_(0) {}
+
+void SightingsAggregator::Add(const EntryInfo& entry) {
+  const common::time64_t ts = entry.GetTimestamp();
+  const common::time64_t second = (ts / 1000) * 1000;
+  const uint64_t key = entry.GetMacAddress().GetValue() | GetIfaceIndex(entry.GetIface()) << 48;
+  Sighting& sighting = seconds_[second][key];
+  sighting.count++;
+  const int8_t ssi = entry.GetSSI();
+  if (ssi != UNKNOWN_SSI) {
+    sighting.ssi_min = sighting.ssi_count ? std::min(sighting.ssi_min, ssi) : ssi;
+    sighting.ssi_max = sighting.ssi_count ? std::max(sighting.ssi_max, ssi) : ssi;
+    sighting.ssi_sum += ssi;
+    sighting.ssi_count++;
+  }
+  newest_ = std::max(newest_, ts);
+  added_++;
+}
+
+void SightingsAggregator::TakeClosed(std::vector<EntryInfo>* entries) {
+  while (!seconds_.empty()) {
+    auto oldest = seconds_.begin();
+    if (oldest->first + 1000 + close_delay_msec > newest_) {
+      break;
+    }
+    TakeSecond(oldest->first, oldest->second, entries);
+    seconds_.erase(oldest);
+  }
+}
+
+void SightingsAggregator::TakeAll(std::vector<EntryInfo>* entries) {
+  for (auto it = seconds_.begin(); it != seconds_.end(); ++it) {
+    TakeSecond(it->first, it->second, entries);
+  }
+  seconds_.clear();
+}
+
+uint64_t SightingsAggregator::GetAddedCount() const {
+  return added_;
+}
+
+bool SightingsAggregator::IsEmpty() const {
+  return seconds_.empty();
+}
+
+void SightingsAggregator::TakeSecond(common::time64_t second,
+                                     const sightings_t& sightings,
+                                     std::vector<EntryInfo>* entries) const {
+  for (auto it = sightings.begin(); it != sightings.end(); ++it) {
+    const Sighting& sighting = it->second;
+    // rounded half away from zero, sum is negative for dBm values and positive for relative ones
+    const int32_t ssi_count = static_cast<int32_t>(sighting.ssi_count);
+    const int32_t half = (sighting.ssi_sum >= 0 ? ssi_count : -ssi_count) / 2;
+    const int8_t mean = ssi_count ? (sighting.ssi_sum + half) / ssi_count : UNKNOWN_SSI;
+    EntryInfo entry(MacAddress::FromValue(it->first), second, mean);
+    entry.SetAggregate(sighting.count, sighting.ssi_min, sighting.ssi_max);
+    entry.SetIface(ifaces_[it->first >> 48]);
+    entries->push_back(entry);
+  }
+}
+
+uint64_t SightingsAggregator::GetIfaceIndex(const std::string& iface) {
+  for (size_t i = 0; i < ifaces_.size(); ++i) {
+    if (ifaces_[i] == iface) {
+      return i;
+    }
+  }
+  ifaces_.push_back(iface);
+  return ifaces_.size() - 1;
+}
+
+}  // namespace client
+}  // namespace sniffer
@@ -0,0 +1,71 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <common/macros.h>
+
+#include "entry_info.h"
+
+namespace sniffer {
+namespace client {
+
+// merges frames of one transmitter on one interface within whole second into single entry,
+// second is closed when entries at least close_delay_msec newer were added
+class SightingsAggregator {
+ public:
+  enum { close_delay_msec = 1000 };
+
+  SightingsAggregator();
+
+  void Add(const EntryInfo& entry);
+  void TakeClosed(std::vector<EntryInfo>* entries);
+  void TakeAll(std::vector<EntryInfo>* entries);
+
+  uint64_t GetAddedCount() const;  // frames since construction
+  bool IsEmpty() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SightingsAggregator);
+
+  struct Sighting {
+    Sighting();
+
+    uint32_t count;
+    uint32_t ssi_count;  // frames with known ssi
+    int32_t ssi_sum;
+    int8_t ssi_min;
+    int8_t ssi_max;
+  };
+
+  // mac | iface index << 48
+  typedef std::unordered_map<uint64_t, Sighting> sightings_t;
+
+  void TakeSecond(common::time64_t second, const sightings_t& sightings, std::vector<EntryInfo>* entries) const;
+  uint64_t GetIfaceIndex(const std::string& iface);
+
+  std::map<common::time64_t, sightings_t> seconds_;  // ordered by second start, msec
+  common::time64_t newest_;
+  std::vector<std::string> ifaces_;
+  uint64_t added_;
+};
+
+}  // namespace client
+}  // namespace sniffer
@@ -14,116 +14,973 @@
 
 #include "client/sniffer_service.h"
 
+#include <algorithm>
 #include <thread>
 
+#include <errno.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <linux/if_packet.h>
+
 #include <common/time.h>
 #include <common/libev/io_loop.h>
 
 #include "pcap_packages/radiotap_header.h"
 
+#include "client/capture_client.h"
+#include "client/entries_ring.h"
+#include "client/entry_spool.h"
+#include "client/handoff_client.h"
+
 #include "sniffer/live_sniffer.h"
+#include "sniffer/replay_sniffer.h"
+#include "sniffer/ring_sniffer.h"
 
 #include "daemon_client/daemon_client.h"
 
+#include "commands_info/activate_info.h"
+#include "commands_info/entries_binary.h"
 #include "commands_info/entries_info.h"
 
 #include "daemon_client/slave_master_commands.h"
 
+#include "mac_select.h"
 #include "utils.h"
 
 namespace sniffer {
 namespace client {
+namespace {
+const int kThroughputBufferSize = 64 * 1024 * 1024;
+const int kLowLatencyBufferSize = 8 * 1024 * 1024;
+const int kLowLatencyBusyPoll = 50;  // usec
+
+sniffer::CaptureOptions MakeCaptureOptions(const CaptureSettings& settings) {
+  sniffer::CaptureOptions options;
+  if (settings.profile == PROFILE_THROUGHPUT) {
+    // header-only frames, big buffer absorbs bursts, wakeups per full buffer or timeout
+    options.snaplen = GetHeaderSnaplen();
+    options.buffer_size = kThroughputBufferSize;
+  } else if (settings.profile == PROFILE_LOW_LATENCY) {
+    options.snaplen = GetHeaderSnaplen();
+    options.buffer_size = kLowLatencyBufferSize;
+    options.immediate = true;
+    options.busy_poll = kLowLatencyBusyPoll;
+  }
+
+  if (settings.snaplen != -1) {
+    options.snaplen = settings.snaplen;
+  }
+  if (settings.buffer_size != -1) {
+    options.buffer_size = settings.buffer_size;
+  }
+  if (settings.immediate != -1) {
+    options.immediate = settings.immediate;
+  }
+  if (settings.busy_poll != -1) {
+    options.busy_poll = settings.busy_poll;
+  }
+  return options;
+}
+
+bool PinThread(std::thread* thread, int cpu) {
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(cpu, &cpuset);
+  return pthread_setaffinity_np(thread->native_handle(), sizeof(cpuset), &cpuset) == 0;
+}
+
+std::string JoinDevices(const std::vector<std::string>& devices) {
+  std::string joined;
+  for (size_t i = 0; i < devices.size(); ++i) {
+    if (i) {
+      joined += ",";
+    }
+    joined += devices[i];
+  }
+  return joined;
+}
+
+const char* CaptureProfileName(CaptureProfile profile) {
+  if (profile == PROFILE_THROUGHPUT) {
+    return "throughput";
+  } else if (profile == PROFILE_LOW_LATENCY) {
+    return "low_latency";
+  }
+  return "default";
+}
+}  // namespace
 
 SnifferService::SnifferService(const std::string& license_key)
-    : base_class("sniffer_service", GetServerHostAndPort(), license_key), config_(), inner_connection_(nullptr) {
+    : base_class("sniffer_service", GetServerHostAndPort(), license_key),
+      config_(),
+      inner_connection_(nullptr),
+      sniffers_(),
+      capture_clients_(),
+      handoff_rings_(),
+      handoff_fd_(-1),
+      handoff_pending_(false),
+      handoff_client_(nullptr),
+      stats_timer_(INVALID_TIMER_ID),
+      mac_filter_(nullptr),
+      mac_filter_timer_(INVALID_TIMER_ID),
+      aggregator_(),
+      aggregate_timer_(INVALID_TIMER_ID),
+      aggregated_at_flush_(0),
+      uplink_batch_(),
+      uplink_timer_(INVALID_TIMER_ID),
+      uplink_window_(UplinkWindow::default_max_batches),
+      retransmit_(),
+      retransmitted_entries_(0),
+      dropped_pending_entries_(0),
+      connection_timer_(INVALID_TIMER_ID),
+      reconnect_delay_(0),
+      reconnect_at_(0),
+      master_activated_(false),
+      spool_(nullptr),
+      spool_timer_(INVALID_TIMER_ID),
+      entries_encoding_(ENTRIES_ENCODING_JSON),
+      uplink_dictionary_(),
+      closed_uplink_stats_(),
+      stats_(),
+      sent_entries_(0),
+      sampled_sent_entries_(0) {
+  for (size_t i = 0; i < PARSE_RESULTS_COUNT; ++i) {
+    parse_results_[i] = 0;
+  }
   ReadConfig(GetConfigPath());
 }
 
-SnifferService::~SnifferService() {}
+SnifferService::~SnifferService() {
+  delete spool_;
+  delete mac_filter_;
+}
 
 int SnifferService::Exec(int argc, char** argv) {
-  sniffer::LiveSniffer* live = new sniffer::LiveSniffer(config_.server.device, this);
-  common::Error err = live->Open();
-  if (err) {
-    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-    return EXIT_FAILURE;
+  ApplyMacSelectRules();
+  const MacFilterSettings& mac_filter = config_.server.mac_filter;
+  if (!mac_filter.path.empty()) {
+    mac_filter_ = new MacFilterReloader(mac_filter.path, mac_filter.mode, mac_filter.bloom);
+    common::Error err = mac_filter_->Load();
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+      return EXIT_FAILURE;
+    }
+  }
+
+  const MasterSettings& master = config_.master;
+  if (!master.spool_dir.empty()) {
+    spool_ = new EntrySpool(master.spool_dir, master.spool_segment_size, master.spool_max_size,
+                            static_cast<common::time64_t>(master.spool_max_age) * 1000);
+    common::Error err = spool_->Open();
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+      return EXIT_FAILURE;
+    }
+    INFO_LOG() << "Spool directory: " << master.spool_dir << ", pending entries: " << spool_->GetPendingCount();
+  }
+
+  CreateSniffers();
+  for (sniffer::ISniffer* sniffer : sniffers_) {
+    common::Error err = sniffer->Open();
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+      CloseSniffers();
+      return EXIT_FAILURE;
+    }
+
+    // pcapng without interface block near file start binds decoder when replay reads it
+    const bool replay = !config_.server.replay_file.empty();
+    const LinkDecoder* decoder = sniffer->GetDecoder();
+    if (!decoder && !(replay && sniffer->GetLinkHeaderType() == -1)) {
+      ERROR_LOG() << "Not supported headers, device: " << sniffer->GetDevice()
+                  << ", header type: " << sniffer->GetLinkHeaderType();
+      CloseSniffers();
+      return EXIT_FAILURE;
+    }
+    if (decoder) {
+      INFO_LOG() << "Link decoder: " << decoder->name << ", device: " << sniffer->GetDevice();
+    } else {
+      WARNING_LOG() << "Link type is not known before first interface block, file: " << config_.server.replay_file;
+    }
+
+    // capture file is replayed as recorded, kernel filter has nothing to attach to
+    if (replay) {
+      continue;
+    }
+
+    const std::string filter = config_.server.filter.empty()
+                                   ? MakeFilterExpression(decoder->link_type, config_.server.mac_deny_list)
+                                   : config_.server.filter;
+    err = sniffer->SetFilter(filter);
+    if (err) {
+      // custom filter is what user asked for, generated one only saves cpu
+      if (!config_.server.filter.empty()) {
+        ERROR_LOG() << "Invalid capture filter: " << filter << ", error: " << err->GetDescription();
+        CloseSniffers();
+        return EXIT_FAILURE;
+      }
+      WARNING_LOG() << "Can't install capture filter: " << filter << ", error: " << err->GetDescription();
+    } else if (sniffer == sniffers_[0]) {
+      INFO_LOG() << "Capture filter: " << filter;
+    }
   }
 
-  int header_type = live->GetLinkHeaderType();
-  if (!(header_type == DLT_IEEE802_11_RADIO || header_type == DLT_EN10MB)) {
-    ERROR_LOG() << "Not supported headers, device header type: " << header_type;
-    return EXIT_FAILURE;
+  std::vector<std::thread> workers;
+  if (IsLoopCapture()) {
+    // pcap handle is polled by the loop, see PreLooped
+    common::Error err = static_cast<sniffer::LiveSniffer*>(sniffers_[0])->SetNonBlocking(true);
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+      CloseSniffers();
+      return EXIT_FAILURE;
+    }
+  } else {
+    handoff_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (handoff_fd_ == -1) {
+      common::ErrnoError errn = common::make_errno_error(errno);
+      DEBUG_MSG_ERROR(errn, common::logging::LOG_LEVEL_ERR);
+      CloseSniffers();
+      return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < sniffers_.size(); ++i) {
+      handoff_rings_.push_back(new EntriesRing(config_.server.handoff_capacity));
+    }
+
+    const std::vector<int>& cpus = config_.server.capture_cpus;
+    const unsigned int cpus_count = std::max(std::thread::hardware_concurrency(), 1u);
+    for (size_t i = 0; i < sniffers_.size(); ++i) {
+      sniffer::ISniffer* sniffer = sniffers_[i];
+      workers.push_back(std::thread([sniffer]() { sniffer->Run(); }));
+      const int cpu = cpus.empty() ? i % cpus_count : cpus[i % cpus.size()];
+      if (!PinThread(&workers.back(), cpu)) {
+        WARNING_LOG() << "Can't pin capture worker[" << i << "] to cpu: " << cpu;
+      }
+    }
   }
 
-  INFO_LOG() << "Opended device: " << live->GetDevice() << ", mac address: " << live->GetMacAddress()
-             << ", link header type: " << header_type;
-  auto th = std::thread([live]() { live->Run(); });
+  INFO_LOG() << "Opended " << (config_.server.replay_file.empty() ? "devices: " + JoinDevices(config_.server.devices)
+                                                                   : "replay file: " + config_.server.replay_file)
+             << ", link header type: " << sniffers_[0]->GetLinkHeaderType()
+             << ", capture workers: " << workers.size();
   int res = base_class::Exec(argc, argv);
-  th.join();
-  live->Close();
-  delete live;
+  for (sniffer::ISniffer* sniffer : sniffers_) {
+    sniffer->Stop();
+  }
+  for (size_t i = 0; i < workers.size(); ++i) {
+    workers[i].join();
+  }
+  for (EntriesRing* ring : handoff_rings_) {
+    delete ring;
+  }
+  handoff_rings_.clear();
+  if (handoff_fd_ != -1) {
+    close(handoff_fd_);
+    handoff_fd_ = -1;
+  }
+  CloseSniffers();
   return res;
 }
 
+void SnifferService::CreateSniffers() {
+  const ServerSettings& settings = config_.server;
+  if (!settings.replay_file.empty()) {
+    if (settings.capture_backend != PCAP_CAPTURE || settings.fanout.workers > 1) {
+      WARNING_LOG() << "Capture backend settings are ignored in replay mode.";
+    }
+    INFO_LOG() << "Replay file: " << settings.replay_file << ", speed: " << settings.replay_speed
+               << (settings.replay_speed > 0 ? "x" : " (unpaced)");
+    sniffers_.push_back(new sniffer::ReplaySniffer(sniffer::FileSniffer::path_type(settings.replay_file), this,
+                                                   settings.replay_speed));
+    return;
+  }
+
+  if (settings.capture_backend == RING_CAPTURE && settings.capture.profile != PROFILE_DEFAULT) {
+    WARNING_LOG() << "Capture profile applies only to pcap capture backend, ignored.";
+  }
+  if (settings.capture_backend == PCAP_CAPTURE && settings.fanout.workers > 1) {
+    WARNING_LOG() << "Fanout capture requires ring capture backend, running single worker per device.";
+  }
+  for (size_t i = 0; i < settings.devices.size(); ++i) {
+    CreateDeviceSniffers(settings.devices[i], i);
+  }
+}
+
+void SnifferService::CreateDeviceSniffers(const std::string& device, size_t index) {
+  const ServerSettings& settings = config_.server;
+  if (settings.capture_backend == RING_CAPTURE) {
+    const uint32_t workers = settings.fanout.workers;
+    INFO_LOG() << "Ring capture on device: " << device << ", block size: " << settings.ring.block_size
+               << ", block count: " << settings.ring.block_count
+               << ", retire timeout: " << settings.ring.retire_timeout << " msec";
+    if (workers < 2) {
+      sniffers_.push_back(new sniffer::RingSniffer(device, this, settings.ring.block_size, settings.ring.block_count,
+                                                   settings.ring.retire_timeout));
+      return;
+    }
+
+    // fanout group is bound to one device, every device gets own group id
+    const uint16_t group = settings.fanout.group + index;
+    uint16_t mode = settings.fanout.mode == FANOUT_CPU ? PACKET_FANOUT_CPU
+                                                       : (PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_DEFRAG);
+    INFO_LOG() << "Fanout group: " << group << ", workers: " << workers
+               << ", mode: " << (settings.fanout.mode == FANOUT_CPU ? "cpu" : "hash");
+    for (uint32_t i = 0; i < workers; ++i) {
+      sniffer::RingSniffer* ring = new sniffer::RingSniffer(device, this, settings.ring.block_size,
+                                                            settings.ring.block_count, settings.ring.retire_timeout);
+      ring->SetFanout(group, mode);
+      sniffers_.push_back(ring);
+    }
+    return;
+  }
+
+  const sniffer::CaptureOptions options = MakeCaptureOptions(settings.capture);
+  INFO_LOG() << "Pcap capture on device: " << device << ", profile: " << CaptureProfileName(settings.capture.profile)
+             << ", snaplen: " << options.snaplen << ", buffer size: " << options.buffer_size
+             << ", immediate: " << options.immediate << ", busy poll: " << options.busy_poll << " usec";
+  sniffers_.push_back(new sniffer::LiveSniffer(device, this, options));
+}
+
+bool SnifferService::IsLoopCapture() const {
+  // one pcap handle is cheapest to poll from the loop, several devices get a pinned thread each
+  return sniffers_.size() == 1 && dynamic_cast<sniffer::LiveSniffer*>(sniffers_[0]);
+}
+
+void SnifferService::CloseSniffers() {
+  for (sniffer::ISniffer* sniffer : sniffers_) {
+    if (sniffer->IsValid()) {
+      common::Error err = sniffer->Close();
+      if (err) {
+        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
+      }
+    }
+    delete sniffer;
+  }
+  sniffers_.clear();
+}
+
+commands_info::StatsInfo SnifferService::SampleStats() {
+  commands_info::StatsInfo::captures_t captures;
+  for (size_t i = 0; i < sniffers_.size(); ++i) {
+    sniffer::CaptureStats stats;
+    common::Error err = sniffers_[i]->GetStats(&stats);
+    UNUSED(err);  // backend without statistics reports zeros
+    captures.push_back(stats);
+  }
+
+  ParseStats parse;
+  for (size_t i = 0; i < PARSE_RESULTS_COUNT; ++i) {
+    parse.results[i] = parse_results_[i].load(std::memory_order_relaxed);
+  }
+  commands_info::StatsInfo stats(config_.server.id, common::time::current_mstime(), captures, parse);
+  stats.SetUplink(GetUplinkStats());
+
+  commands_info::UplinkAckStats acks;
+  acks.inflight = uplink_window_.GetInflightCount();
+  acks.retransmitted = retransmitted_entries_;
+  acks.dropped = dropped_pending_entries_ + (spool_ ? spool_->GetDroppedCount() : 0);
+  acks.rtt_p50 = uplink_window_.GetRttPercentile(50);
+  acks.rtt_p90 = uplink_window_.GetRttPercentile(90);
+  acks.rtt_p99 = uplink_window_.GetRttPercentile(99);
+  stats.SetUplinkAcks(acks);
+  return stats;
+}
+
+protocol::CompressionStats SnifferService::GetUplinkStats() {
+  protocol::CompressionStats stats = closed_uplink_stats_;
+  if (inner_connection_) {
+    const protocol::CompressionStats current = inner_connection_->GetFrameCodec()->GetStats();
+    stats.raw_bytes += current.raw_bytes;
+    stats.wire_bytes += current.wire_bytes;
+    stats.compressed_frames += current.compressed_frames;
+  }
+  return stats;
+}
+
+void SnifferService::DumpCaptureStats() {
+  const commands_info::StatsInfo prev = stats_;
+  stats_ = SampleStats();
+  const common::time64_t interval = stats_.GetTimestamp() - prev.GetTimestamp();
+  if (prev.GetTimestamp() && interval > 0) {
+    const uint64_t received = stats_.GetTotalCapture().received - prev.GetTotalCapture().received;
+    const uint64_t sent = sent_entries_ - sampled_sent_entries_;
+    INFO_LOG() << "Capture rate: " << received * 1000 / interval << " packets/sec, uplink rate: "
+               << sent * 1000 / interval << " entries/sec, aggregated frames: " << aggregator_.GetAddedCount();
+  }
+  sampled_sent_entries_ = sent_entries_;
+
+  const protocol::CompressionStats uplink = stats_.GetUplink();
+  INFO_LOG() << "Uplink raw bytes: " << uplink.raw_bytes << ", wire bytes: " << uplink.wire_bytes
+             << ", compressed frames: " << uplink.compressed_frames;
+  const commands_info::UplinkAckStats acks = stats_.GetUplinkAcks();
+  INFO_LOG() << "Uplink inflight requests: " << acks.inflight << "/" << uplink_window_.GetMaxBatches()
+             << ", retransmitted entries: " << acks.retransmitted << ", dropped entries: " << acks.dropped
+             << ", rtt p50/p90/p99: " << acks.rtt_p50 << "/" << acks.rtt_p90 << "/" << acks.rtt_p99 << " msec";
+
+  if (spool_) {
+    INFO_LOG() << "Spool pending entries: " << spool_->GetPendingCount() << ", size: " << spool_->GetSize()
+               << ", dropped: " << spool_->GetDroppedCount();
+  } else {
+    INFO_LOG() << "Pending entries: " << uplink_batch_.size() + retransmit_.size()
+               << ", dropped: " << dropped_pending_entries_;
+  }
+
+  const commands_info::StatsInfo::captures_t captures = stats_.GetCaptures();
+  for (size_t i = 0; i < captures.size(); ++i) {
+    INFO_LOG() << "Capture worker[" << i << "] device: " << sniffers_[i]->GetDevice()
+               << ", received: " << captures[i].received
+               << ", dropped: " << captures[i].dropped << ", interface dropped: " << captures[i].if_dropped;
+    if (i < handoff_rings_.size()) {
+      const EntriesRing* ring = handoff_rings_[i];
+      INFO_LOG() << "Capture worker[" << i << "] handoff high water: " << ring->GetHighWater() << "/"
+                 << ring->GetCapacity() << ", handoff dropped: " << ring->GetDropped();
+    }
+  }
+
+  const ParseStats parse = stats_.GetParseStats();
+  INFO_LOG() << "Parsed ok: " << parse.results[PARSE_OK] << ", skipped: " << parse.results[PARSE_SKIPPED_PACKET]
+             << ", invalid: "
+             << parse.results[PARSE_INVALID_INPUT] + parse.results[PARSE_INVALID_HEADER_SIZE] +
+                    parse.results[PARSE_INVALID_FRAMECONTROL_SIZE] + parse.results[PARSE_INVALID_PACKET];
+
+  if (config_.master.send_stats) {
+    SendStats(stats_);
+  }
+}
+
+void SnifferService::SendStats(const commands_info::StatsInfo& stats) {
+  CHECK(loop_->IsLoopThread());
+  if (!inner_connection_) {
+    return;
+  }
+
+  std::string stats_str;
+  common::Error serialize_error = stats.SerializeToString(&stats_str);
+  if (serialize_error) {
+    return;
+  }
+
+  protocol::request_t req = daemon_client::StatsSlaveRequest(NextRequestID(), stats_str);
+  common::Error err = static_cast<daemon_client::ProtocoledDaemonClient*>(inner_connection_)->WriteRequest(req);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
+    daemon_client::DaemonClient* connection = inner_connection_;
+    err = connection->Close();
+    DCHECK(!err) << "Close connection error: " << err->GetDescription();
+    delete connection;
+  }
+}
+
+void SnifferService::ApplyMacSelectRules() {
+  const ServerSettings& settings = config_.server;
+  MacSelectRules rules;
+  if (settings.mac_skip_local) {
+    rules.reject_bits |= MAC_LOCAL_BIT;
+  }
+  const std::vector<MacAddress>& deny = settings.mac_deny_list;
+  rules.deny_count = std::min<size_t>(deny.size(), MacSelectRules::max_deny);
+  for (size_t i = 0; i < rules.deny_count; ++i) {
+    rules.deny[i] = deny[i].GetValue();
+  }
+  if (deny.size() > rules.deny_count) {
+    WARNING_LOG() << "Only first " << rules.deny_count << " addresses of mac_deny_list are checked in parser, "
+                  << "use mac_filter_file for long lists.";
+  }
+  SetMacSelectRules(rules);
+  INFO_LOG() << "Mac select kernel: " << GetMacSelectKernelName() << ", skip local: " << settings.mac_skip_local;
+}
+
+void SnifferService::CheckMacFilter() {
+  CHECK(loop_->IsLoopThread());
+  bool reloaded;
+  common::Error err = mac_filter_->ReloadIfChanged(&reloaded);
+  if (err) {
+    // broken file keeps previous filter installed
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
+  }
+}
+
+common::Error SnifferService::MakeStats(std::string* serialized) {
+  if (!serialized) {
+    return common::make_error_inval();
+  }
+
+  if (!stats_.GetTimestamp()) {  // before first timer tick
+    stats_ = SampleStats();
+  }
+  return stats_.SerializeToString(serialized);
+}
+
 common::file_system::ascii_file_string_path SnifferService::GetConfigPath() {
   return common::file_system::ascii_file_string_path(CONFIG_FILE_PATH);
 }
 
 void SnifferService::PreLooped(common::libev::IoLoop* server) {
+  if (IsLoopCapture()) {
+    CaptureClient* capture = new CaptureClient(server, static_cast<sniffer::LiveSniffer*>(sniffers_[0]));
+    capture_clients_.push_back(capture);
+    server->RegisterClient(capture);
+  }
+  if (handoff_fd_ != -1) {
+    handoff_client_ = new HandoffClient(server, handoff_fd_);
+    server->RegisterClient(handoff_client_);
+  }
+  stats_timer_ = server->CreateTimer(stats_interval_seconds, true);
+  if (mac_filter_) {
+    mac_filter_timer_ = server->CreateTimer(mac_filter_check_seconds, true);
+  }
+  if (config_.server.aggregate_entries) {
+    aggregate_timer_ = server->CreateTimer(aggregate_flush_seconds, true);
+  }
+  if (config_.master.batch_size > 1) {
+    uplink_timer_ = server->CreateTimer(config_.master.batch_timeout / 1000.0, true);
+  }
+  uplink_window_.SetMaxBatches(config_.master.uplink_window);
+  connection_timer_ = server->CreateTimer(connection_check_seconds, true);
+  reconnect_delay_ = static_cast<common::time64_t>(config_.master.reconnect_interval) * 1000;
+  if (spool_) {
+    spool_timer_ = server->CreateTimer(1.0 / spool_replay_ticks, true);
+  }
   Connect(server);
   base_class::PreLooped(server);
 }
 
 void SnifferService::PostLooped(common::libev::IoLoop* server) {
+  if (stats_timer_ != INVALID_TIMER_ID) {
+    server->RemoveTimer(stats_timer_);
+    stats_timer_ = INVALID_TIMER_ID;
+  }
+  if (mac_filter_timer_ != INVALID_TIMER_ID) {
+    server->RemoveTimer(mac_filter_timer_);
+    mac_filter_timer_ = INVALID_TIMER_ID;
+  }
+  if (aggregate_timer_ != INVALID_TIMER_ID) {
+    server->RemoveTimer(aggregate_timer_);
+    aggregate_timer_ = INVALID_TIMER_ID;
+  }
+  if (uplink_timer_ != INVALID_TIMER_ID) {
+    server->RemoveTimer(uplink_timer_);
+    uplink_timer_ = INVALID_TIMER_ID;
+  }
+  if (connection_timer_ != INVALID_TIMER_ID) {
+    server->RemoveTimer(connection_timer_);
+    connection_timer_ = INVALID_TIMER_ID;
+  }
+  if (spool_timer_ != INVALID_TIMER_ID) {
+    server->RemoveTimer(spool_timer_);
+    spool_timer_ = INVALID_TIMER_ID;
+  }
+  if (handoff_client_) {
+    DrainHandoff();
+    HandoffClient* handoff = handoff_client_;
+    common::Error err = handoff->Close();  // handoff_client_ is reset in Closed
+    DCHECK(!err) << "Close handoff error: " << err->GetDescription();
+    delete handoff;
+  }
+  FlushSightings();
+  FlushUplink();
   DisConnect(common::Error());
   CHECK(!inner_connection_);
+  FlushUplink();  // held by full window, spooled without connection
+  if (spool_) {
+    SpoolEntries(retransmit_.data(), retransmit_.size());
+    spool_->Sync();
+  } else {
+    dropped_pending_entries_ += retransmit_.size();  // nowhere to keep them after exit
+  }
+  retransmit_.clear();
+  while (!capture_clients_.empty()) {
+    CaptureClient* capture = capture_clients_.back();
+    common::Error err = capture->Close();  // removed from capture_clients_ in Closed
+    DCHECK(!err) << "Close capture error: " << err->GetDescription();
+    delete capture;
+  }
   base_class::PostLooped(server);
 }
 
 void SnifferService::Closed(common::libev::IoClient* client) {
   if (client == inner_connection_) {
+    closed_uplink_stats_ = GetUplinkStats();
+    const std::string dictionary = inner_connection_->GetFrameCodec()->GetDictionary();
+    if (!dictionary.empty()) {
+      uplink_dictionary_ = dictionary;
+    }
     inner_connection_ = nullptr;
+    master_activated_ = false;
+    RequeueUnacknowledged();
+    ScheduleReconnect();
   }
+  if (client == handoff_client_) {
+    handoff_client_ = nullptr;
+  }
+  capture_clients_.erase(std::remove(capture_clients_.begin(), capture_clients_.end(), client),
+                         capture_clients_.end());
   base_class::Closed(client);
 }
 
+void SnifferService::DataReceived(common::libev::IoClient* client) {
+  if (CaptureClient* capture = dynamic_cast<CaptureClient*>(client)) {
+    common::Error err = capture->ReadPackets();
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+      err = capture->Close();  // removed from capture_clients_ in Closed
+      DCHECK(!err) << "Close capture error: " << err->GetDescription();
+      delete capture;
+      if (capture_clients_.empty()) {  // nothing left to sniff
+        ERROR_LOG() << "Last capture device failed, stopping service.";
+        loop_->Stop();
+      }
+    }
+    return;
+  }
+
+  if (client == handoff_client_) {
+    common::Error err = handoff_client_->ClearWakeups();
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
+    }
+    DrainHandoff();
+    return;
+  }
+
+  base_class::DataReceived(client);
+}
+
+void SnifferService::TimerEmited(common::libev::IoLoop* server, common::libev::timer_id_t id) {
+  if (stats_timer_ == id) {
+    MaintainSpool();
+    DumpCaptureStats();
+  } else if (mac_filter_timer_ == id) {
+    CheckMacFilter();
+  } else if (aggregate_timer_ == id) {
+    FlushIdleSightings();
+  } else if (uplink_timer_ == id) {
+    FlushUplink();
+  } else if (connection_timer_ == id) {
+    CheckConnection(server);
+  } else if (spool_timer_ == id) {
+    ReplaySpool();
+  }
+  base_class::TimerEmited(server, id);
+}
+
 void SnifferService::HandlePacket(sniffer::ISniffer* sniffer, const u_char* packet, const pcap_pkthdr* header) {
-  EntryInfo ent;
-  sniffer::LiveSniffer* live = static_cast<sniffer::LiveSniffer*>(sniffer);
-  if (live->GetLinkHeaderType() == DLT_IEEE802_11_RADIO) {
-    PARSE_RESULT res = MakeEntryFromRadioTap(packet, header, &ent);
-    if (res != PARSE_OK) {
-      return;
+  sniffer::Packet single;
+  single.header = *header;
+  single.data = packet;
+  HandlePackets(sniffer, &single, 1);
+}
+
+void SnifferService::HandlePackets(sniffer::ISniffer* sniffer, const sniffer::Packet* packets, size_t count) {
+  std::vector<EntryInfo> entries;
+  entries.reserve(count);
+  ParseStats parse;
+  const LinkDecoder* decoder = sniffer->GetDecoder();
+  if (decoder) {
+    decoder->parse(packets, count, &entries, &parse);
+  } else {
+    parse.results[PARSE_INVALID_INPUT] += count;
+  }
+  for (size_t i = 0; i < PARSE_RESULTS_COUNT; ++i) {
+    if (parse.results[i]) {
+      parse_results_[i].fetch_add(parse.results[i], std::memory_order_relaxed);
     }
-  } else if (live->GetLinkHeaderType() == DLT_EN10MB) {
-    PARSE_RESULT res = MakeEntryFromEthernet(packet, header, &ent);
-    if (res != PARSE_OK) {
-      return;
+  }
+  if (entries.empty()) {
+    return;
+  }
+
+  const std::string iface = sniffer->GetDevice();
+  for (size_t i = 0; i < entries.size(); ++i) {
+    EntryInfo* ent = &entries[i];
+    ent->SetTimestamp((ent->GetTimestamp() / 1000) * 1000);
+    ent->SetIface(iface);
+  }
+
+  if (loop_->IsLoopThread()) {  // pcap capture dispatched by the loop
+    DeliverEntries(entries);
+    return;
+  }
+
+  // ring and replay workers run outside of the loop thread, connection is owned by the loop
+  HandOffEntries(sniffer, entries);
+}
+
+void SnifferService::HandOffEntries(sniffer::ISniffer* sniffer, const std::vector<EntryInfo>& entries) {
+  EntriesRing* ring = nullptr;
+  for (size_t i = 0; i < sniffers_.size(); ++i) {
+    if (sniffers_[i] == sniffer) {
+      ring = handoff_rings_[i];
+      break;
+    }
+  }
+  if (!ring) {
+    DNOTREACHED();
+    return;
+  }
+
+  // full ring counts drops, capture worker never waits for loop thread
+  if (!ring->Push(entries.data(), entries.size())) {
+    return;
+  }
+
+  if (!handoff_pending_.exchange(true, std::memory_order_acq_rel)) {
+    const uint64_t wakeup = 1;
+    ssize_t res = write(handoff_fd_, &wakeup, sizeof(wakeup));
+    UNUSED(res);  // counter can't overflow, one write per drain
+  }
+}
+
+void SnifferService::DrainHandoff() {
+  CHECK(loop_->IsLoopThread());
+  // pushes after this point signal eventfd again
+  handoff_pending_.exchange(false, std::memory_order_acq_rel);
+  std::vector<EntryInfo> entries;
+  for (EntriesRing* ring : handoff_rings_) {
+    entries.clear();
+    if (ring->Pop(&entries)) {
+      DeliverEntries(entries);
+    }
+  }
+}
+
+void SnifferService::DeliverEntries(const std::vector<EntryInfo>& entries) {
+  CHECK(loop_->IsLoopThread());
+  if (!config_.server.aggregate_entries) {
+    SendEntries(entries);
+    return;
+  }
+
+  for (size_t i = 0; i < entries.size(); ++i) {
+    aggregator_.Add(entries[i]);
+  }
+  // closed seconds wait in aggregator until master acknowledges, bounded by ack_timeout
+  if (IsUplinkBlocked()) {
+    return;
+  }
+
+  std::vector<EntryInfo> closed;
+  aggregator_.TakeClosed(&closed);
+  SendEntries(closed);
+}
+
+void SnifferService::FlushIdleSightings() {
+  // seconds are closed by newer frames, without traffic they are closed by time
+  const uint64_t added = aggregator_.GetAddedCount();
+  if (added == aggregated_at_flush_ && !IsUplinkBlocked()) {
+    FlushSightings();
+  }
+  aggregated_at_flush_ = added;
+}
+
+void SnifferService::FlushSightings() {
+  CHECK(loop_->IsLoopThread());
+  if (aggregator_.IsEmpty()) {
+    return;
+  }
+
+  std::vector<EntryInfo> entries;
+  aggregator_.TakeAll(&entries);
+  SendEntries(entries);
+}
+
+void SnifferService::SendEntries(const std::vector<EntryInfo>& entries) {
+  CHECK(loop_->IsLoopThread());
+  uplink_batch_.insert(uplink_batch_.end(), entries.begin(), entries.end());
+  SendUplinkBatches(false);
+  // without aggregation capture is not held back, queue behind full window is bounded here
+  BoundPending(&uplink_batch_);
+}
+
+void SnifferService::FlushUplink() {
+  CHECK(loop_->IsLoopThread());
+  SendUplinkBatches(true);
+}
+
+void SnifferService::SendUplinkBatches(bool partial) {
+  const size_t batch_size = std::max<size_t>(config_.master.batch_size, 1);
+  size_t sent = 0;
+  while (!IsUplinkBlocked()) {
+    const size_t left = uplink_batch_.size() - sent;
+    if (!left || (left < batch_size && !partial)) {
+      break;
+    }
+
+    const size_t count = std::min(left, batch_size);
+    if (batch_size == 1) {  // masters without SLAVE_SEND_ENTRIES
+      SendEntry(uplink_batch_[sent]);
+    } else {
+      SendEntriesRequest(uplink_batch_.data() + sent, count);
     }
+    sent += count;
+  }
+  uplink_batch_.erase(uplink_batch_.begin(), uplink_batch_.begin() + sent);
+}
+
+bool SnifferService::IsUplinkBlocked() const {
+  return inner_connection_ && uplink_window_.IsFull();
+}
+
+void SnifferService::ResumeUplink() {
+  SendUplinkBatches(false);
+  if (config_.server.aggregate_entries && !IsUplinkBlocked()) {
+    std::vector<EntryInfo> closed;
+    aggregator_.TakeClosed(&closed);
+    SendEntries(closed);
+  }
+}
+
+void SnifferService::RequeueUnacknowledged() {
+  // master may have stored some of them before connection was lost, duplicates are preferred to gaps
+  std::vector<EntryInfo> entries;
+  uplink_window_.TakeAll(&entries);
+  RequeueEntries(entries);
+}
+
+void SnifferService::RequeueEntries(const std::vector<EntryInfo>& entries) {
+  if (entries.empty()) {
+    return;
+  }
+
+  retransmitted_entries_ += entries.size();
+  SpoolEntries(entries.data(), entries.size());
+}
+
+void SnifferService::BoundPending(std::vector<EntryInfo>* pending) {
+  const size_t max_entries = config_.master.pending_max_entries;
+  if (pending->size() <= max_entries) {
+    return;
+  }
+
+  const size_t excess = pending->size() - max_entries;
+  if (spool_) {
+    SpoolEntries(pending->data(), excess);
   } else {
+    dropped_pending_entries_ += excess;
+  }
+  pending->erase(pending->begin(), pending->begin() + excess);
+}
+
+void SnifferService::RetransmitEntries() {
+  if (retransmit_.empty() || !inner_connection_ || !master_activated_ || IsUplinkBlocked()) {
     return;
   }
 
-  ent.SetTimestamp((ent.GetTimestamp() / 1000) * 1000);
-  if (inner_connection_) {
-    std::string ent_str;
-    common::Error serialize_error = ent.SerializeToString(&ent_str);
+  std::vector<EntryInfo> entries;
+  entries.swap(retransmit_);
+  SendEntries(entries);
+}
+
+void SnifferService::SendEntriesRequest(const EntryInfo* entries, size_t count) {
+  if (!inner_connection_) {
+    SpoolEntries(entries, count);
+    return;
+  }
+
+  const bool binary = entries_encoding_ == ENTRIES_ENCODING_BINARY;
+  std::string entries_str;
+  if (binary) {
+    commands_info::EncodeEntriesBinary(entries, count, &entries_str);
+  } else {
+    commands_info::EntriesInfo entries_info;
+    for (size_t i = 0; i < count; ++i) {
+      entries_info.AddEntry(entries[i]);
+    }
+
+    common::Error serialize_error = entries_info.SerializeToString(&entries_str);
     if (serialize_error) {
       return;
     }
+  }
 
-    protocol::request_t req = daemon_client::EntrySlaveRequest(NextRequestID(), ent_str);
-    common::Error err = static_cast<daemon_client::ProtocoledDaemonClient*>(inner_connection_)->WriteRequest(req);
-    if (err) {
-      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
-      daemon_client::DaemonClient* connection = inner_connection_;
-      err = connection->Close();
-      DCHECK(!err) << "Close connection error: " << err->GetDescription();
-      delete connection;
-    }
+  // long interface names can push batch over command limit, halves are sent separately
+  if (entries_str.size() + command_overhead > protocol::MAX_COMMAND_SIZE && count > 1) {
+    const size_t half = count / 2;
+    SendEntriesRequest(entries, half);
+    SendEntriesRequest(entries + half, count - half);
+    return;
+  }
+
+  const protocol::sequance_id_t id = NextRequestID();
+  protocol::request_t req = binary ? daemon_client::EntriesBinarySlaveRequest(id, entries_str)
+                                   : daemon_client::EntriesSlaveRequest(id, entries_str);
+  common::Error err = static_cast<daemon_client::ProtocoledDaemonClient*>(inner_connection_)->WriteRequest(req);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
+    daemon_client::DaemonClient* connection = inner_connection_;
+    err = connection->Close();
+    DCHECK(!err) << "Close connection error: " << err->GetDescription();
+    delete connection;
+    SpoolEntries(entries, count);
+    return;
+  }
+  uplink_window_.Add(id, entries, count, common::time::current_mstime());
+  sent_entries_ += count;
+}
+
+void SnifferService::SendEntry(const EntryInfo& entry) {
+  CHECK(loop_->IsLoopThread());
+  if (!inner_connection_) {
+    SpoolEntries(&entry, 1);
+    return;
+  }
+
+  std::string ent_str;
+  common::Error serialize_error = entry.SerializeToString(&ent_str);
+  if (serialize_error) {
+    return;
+  }
+
+  const protocol::sequance_id_t id = NextRequestID();
+  protocol::request_t req = daemon_client::EntrySlaveRequest(id, ent_str);
+  common::Error err = static_cast<daemon_client::ProtocoledDaemonClient*>(inner_connection_)->WriteRequest(req);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
+    daemon_client::DaemonClient* connection = inner_connection_;
+    err = connection->Close();
+    DCHECK(!err) << "Close connection error: " << err->GetDescription();
+    delete connection;
+    SpoolEntries(&entry, 1);
+    return;
   }
-  INFO_LOG() << "Received packet, mac: " << ent.GetMacAddress() << ", time: " << ent.GetTimestamp()
-             << ", ssi: " << static_cast<int>(ent.GetSSI());
+  uplink_window_.Add(id, &entry, 1, common::time::current_mstime());
+  sent_entries_++;
+}
+
+void SnifferService::SpoolEntries(const EntryInfo* entries, size_t count) {
+  if (!spool_) {  // kept in memory until reconnect, bounded and counted like queue behind window
+    retransmit_.insert(retransmit_.end(), entries, entries + count);
+    BoundPending(&retransmit_);
+    return;
+  }
+
+  common::Error err = spool_->Append(entries, count);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
+  }
+}
+
+void SnifferService::ReplaySpool() {
+  CHECK(loop_->IsLoopThread());
+  // entries stay on disk until master accepted activation, rejected ones would be lost
+  if (!inner_connection_ || !master_activated_ || IsUplinkBlocked() || spool_->IsEmpty()) {
+    return;
+  }
+
+  std::vector<EntryInfo> entries;
+  spool_->Read(std::max<size_t>(config_.master.spool_replay_rate / spool_replay_ticks, 1), &entries);
+  SendEntries(entries);  // interleaved with live batches, written back if connection fails again
+}
+
+void SnifferService::MaintainSpool() {
+  if (!spool_) {
+    return;
+  }
+
+  spool_->Expire(common::time::current_mstime());
+  spool_->Sync();
 }
 
 common::Error SnifferService::HandleRequestServiceCommand(daemon_client::DaemonClient* dclient,
@@ -137,6 +994,48 @@ common::Error SnifferService::HandleResponceServiceCommand(daemon_client::Daemon
                                                            protocol::sequance_id_t id,
                                                            int argc,
                                                            char* argv[]) {
+  // "ok|fail send_entries ...", rejected entries are stored again and retried
+  if (dclient == inner_connection_ && argc > 0) {
+    if (IS_EQUAL_COMMAND(argv[0], SUCCESS_COMMAND)) {
+      if (uplink_window_.Ack(id, common::time::current_mstime())) {
+        ResumeUplink();
+        return common::Error();
+      }
+    } else {
+      std::vector<EntryInfo> rejected;
+      if (uplink_window_.Reject(id, &rejected)) {
+        WARNING_LOG() << "Master rejected " << rejected.size() << " entries: " << (argc > 2 ? argv[2] : "");
+        RequeueEntries(rejected);
+        ResumeUplink();
+        return common::Error();
+      }
+    }
+  }
+
+  // "ok activate_request [encoding compression]", older masters accept activation without them
+  if (dclient == inner_connection_ && argc > 1 && IS_EQUAL_COMMAND(argv[0], SUCCESS_COMMAND) &&
+      IS_EQUAL_COMMAND(argv[1], SLAVE_ACTIVATE)) {
+    master_activated_ = true;
+    const std::string encoding = argc > 2 ? argv[2] : ENTRIES_ENCODING_JSON;
+    if (config_.master.binary_entries && encoding == ENTRIES_ENCODING_BINARY) {
+      entries_encoding_ = encoding;
+    }
+
+    const std::string compression = argc > 3 ? argv[3] : FRAME_COMPRESSION_NONE;
+    if (config_.master.compression && compression == FRAME_COMPRESSION_ZSTD) {
+      protocol::FrameCodec* codec = dclient->GetFrameCodec();
+      if (!uplink_dictionary_.empty()) {
+        codec->SetDictionary(uplink_dictionary_);
+      }
+      codec->EnableCompression(config_.master.compression_threshold, config_.master.compression_dictionary);
+    }
+    INFO_LOG() << "Master accepted activation, entries encoding: " << entries_encoding_
+               << ", compression: " << (dclient->GetFrameCodec()->IsCompressionEnabled() ? compression : "none");
+    reconnect_delay_ = static_cast<common::time64_t>(config_.master.reconnect_interval) * 1000;
+    RetransmitEntries();
+    return common::Error();
+  }
+
   return base_class::HandleResponceServiceCommand(dclient, id, argc, argv);
 }
 
@@ -157,18 +1056,42 @@ void SnifferService::Connect(common::libev::IoLoop* server) {
   }
 
   DisConnect(common::make_error("Reconnect"));
+  master_activated_ = false;
 
   common::net::HostAndPort host = config_.master.node_host;
   common::net::socket_info client_info;
   common::ErrnoError err = common::net::connect(host, common::net::ST_SOCK_STREAM, 0, &client_info);
   if (err) {
     DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    ScheduleReconnect();
     return;
   }
 
   daemon_client::DaemonClient* connection = new daemon_client::DaemonClient(server, client_info);
   inner_connection_ = connection;
   server->RegisterClient(connection);
+  entries_encoding_ = ENTRIES_ENCODING_JSON;
+
+  // master accepts entries and stats only from verified slaves
+  commands_info::ActivateSlaveInfo activate_req(config_.master.node_license_key, config_.server.id);
+  if (config_.master.binary_entries) {
+    activate_req.SetEntriesEncoding(ENTRIES_ENCODING_BINARY);
+  }
+  if (config_.master.compression) {
+    activate_req.SetCompression(FRAME_COMPRESSION_ZSTD);
+  }
+  std::string activate_str;
+  common::Error serialize_error = activate_req.SerializeToString(&activate_str);
+  if (serialize_error) {
+    DEBUG_MSG_ERROR(serialize_error, common::logging::LOG_LEVEL_ERR);
+    return;
+  }
+
+  protocol::request_t req = daemon_client::ActivateSlaveRequest(NextRequestID(), activate_str);
+  common::Error write_err = static_cast<daemon_client::ProtocoledDaemonClient*>(connection)->WriteRequest(req);
+  if (write_err) {
+    DEBUG_MSG_ERROR(write_err, common::logging::LOG_LEVEL_ERR);
+  }
 }
 
 void SnifferService::DisConnect(common::Error err) {
@@ -180,5 +1103,33 @@ void SnifferService::DisConnect(common::Error err) {
     delete connection;
   }
 }
+
+void SnifferService::CheckConnection(common::libev::IoLoop* server) {
+  const common::time64_t now = common::time::current_mstime();
+  if (inner_connection_) {
+    // half open connection never fails writes, missing acks are the only sign of it
+    const common::time64_t oldest = uplink_window_.GetOldestSentTime();
+    const common::time64_t ack_timeout = static_cast<common::time64_t>(config_.master.ack_timeout) * 1000;
+    if (oldest && now - oldest > ack_timeout) {
+      WARNING_LOG() << "Master didn't acknowledge entries for " << now - oldest << " msec, reconnecting.";
+      DisConnect(common::make_error("Ack timeout"));
+      return;
+    }
+    RetransmitEntries();  // rejected ones are retried once per check
+    return;
+  }
+
+  if (config_.master.reconnect_interval && now >= reconnect_at_) {
+    Connect(server);
+  }
+}
+
+void SnifferService::ScheduleReconnect() {
+  // jitter keeps slaves of restarted master from reconnecting at once
+  const common::time64_t jitter = reconnect_delay_ / 4 ? random() % (reconnect_delay_ / 4) : 0;
+  reconnect_at_ = common::time::current_mstime() + reconnect_delay_ + jitter;
+  const common::time64_t max_delay = static_cast<common::time64_t>(config_.master.reconnect_max_interval) * 1000;
+  reconnect_delay_ = std::max(std::min(reconnect_delay_ * 2, max_delay), reconnect_delay_);
+}
 }
 }
@@ -14,19 +14,41 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "process_wrapper.h"
 
 #include "sniffer/isniffer_observer.h"
+#include "sniffer/isniffer.h"
+
+#include "commands_info/stats_info.h"
 
 #include "config.h"
+#include "sightings_aggregator.h"
+#include "uplink_window.h"
+#include "entry_info.h"
+#include "mac_filter.h"
+#include "utils.h"
 
 namespace sniffer {
 namespace client {
+class CaptureClient;
+class EntriesRing;
+class EntrySpool;
+class HandoffClient;
 
 class SnifferService : public ProcessWrapper, public sniffer::ISnifferObserver {
  public:
   typedef ProcessWrapper base_class;
-  enum { client_port = 6318 };
+  enum {
+    client_port = 6318,
+    stats_interval_seconds = 10,
+    mac_filter_check_seconds = 5,
+    aggregate_flush_seconds = 1,
+    connection_check_seconds = 1,
+    spool_replay_ticks = 10,  // per second, replay rate is split between them
+    command_overhead = 256  // request framing around serialized entries
+  };
 
   SnifferService(const std::string& license_key);
   virtual ~SnifferService();
@@ -40,10 +62,13 @@ class SnifferService : public ProcessWrapper, public sniffer::ISnifferObserver {
   virtual void PreLooped(common::libev::IoLoop* server) override;
   virtual void PostLooped(common::libev::IoLoop* server) override;
   virtual void Closed(common::libev::IoClient* client) override;
+  virtual void DataReceived(common::libev::IoClient* client) override;
+  virtual void TimerEmited(common::libev::IoLoop* server, common::libev::timer_id_t id) override;
 
   virtual void HandlePacket(sniffer::ISniffer* sniffer,
                             const u_char* packet,
                             const struct pcap_pkthdr* header) override;
+  virtual void HandlePackets(sniffer::ISniffer* sniffer, const sniffer::Packet* packets, size_t count) override;
 
   virtual common::Error HandleRequestServiceCommand(daemon_client::DaemonClient* dclient,
                                                     protocol::sequance_id_t id,
@@ -54,14 +79,81 @@ class SnifferService : public ProcessWrapper, public sniffer::ISnifferObserver {
                                                      int argc,
                                                      char* argv[]) override WARN_UNUSED_RESULT;
 
+  virtual common::Error MakeStats(std::string* serialized) override WARN_UNUSED_RESULT;
+
  private:
   void Connect(common::libev::IoLoop* server);
   void DisConnect(common::Error err);
+  void CheckConnection(common::libev::IoLoop* server);
+  void ScheduleReconnect();
+
+  void CreateSniffers();
+  void CreateDeviceSniffers(const std::string& device, size_t index);
+  bool IsLoopCapture() const;
+  void CloseSniffers();
+  commands_info::StatsInfo SampleStats();
+  protocol::CompressionStats GetUplinkStats();
+  void DumpCaptureStats();
+  void SendStats(const commands_info::StatsInfo& stats);
+  void ApplyMacSelectRules();
+  void CheckMacFilter();
+
+  // capture workers queue entries for loop thread, eventfd is signalled once until drained
+  void HandOffEntries(sniffer::ISniffer* sniffer, const std::vector<EntryInfo>& entries);
+  void DrainHandoff();
+  void DeliverEntries(const std::vector<EntryInfo>& entries);
+  void FlushIdleSightings();
+  void FlushSightings();
+  void SendEntries(const std::vector<EntryInfo>& entries);
+  void FlushUplink();
+  void SendUplinkBatches(bool partial);
+  bool IsUplinkBlocked() const;  // window of unacknowledged requests is full
+  void ResumeUplink();
+  void RequeueUnacknowledged();
+  void RequeueEntries(const std::vector<EntryInfo>& entries);
+  void RetransmitEntries();
+  void BoundPending(std::vector<EntryInfo>* pending);  // oldest above pending_max_entries
+  void SendEntriesRequest(const EntryInfo* entries, size_t count);
+  void SendEntry(const EntryInfo& entry);
+  void SpoolEntries(const EntryInfo* entries, size_t count);
+  void ReplaySpool();
+  void MaintainSpool();
 
   void ReadConfig(const common::file_system::ascii_file_string_path& config_path);
 
   Config config_;
   daemon_client::DaemonClient* inner_connection_;
+  std::vector<sniffer::ISniffer*> sniffers_;
+  std::vector<CaptureClient*> capture_clients_;  // registered live sniffers
+  std::vector<EntriesRing*> handoff_rings_;      // one per capture worker, index as in sniffers_
+  int handoff_fd_;                               // eventfd, -1 when capture runs on loop thread
+  std::atomic<bool> handoff_pending_;            // handoff_fd_ signalled and rings not yet drained
+  HandoffClient* handoff_client_;                // registers handoff_fd_ while loop runs
+  common::libev::timer_id_t stats_timer_;
+  MacFilterReloader* mac_filter_;  // NULL if filter file is not configured
+  common::libev::timer_id_t mac_filter_timer_;
+  SightingsAggregator aggregator_;  // loop thread only
+  common::libev::timer_id_t aggregate_timer_;
+  uint64_t aggregated_at_flush_;  // added to aggregator_ when idle flush last checked
+  std::vector<EntryInfo> uplink_batch_;  // loop thread only, sent as one SLAVE_SEND_ENTRIES
+  common::libev::timer_id_t uplink_timer_;
+  UplinkWindow uplink_window_;         // requests of inner_connection_ waiting for ack
+  std::vector<EntryInfo> retransmit_;  // not delivered without spool, resent while activated
+  uint64_t retransmitted_entries_;     // loop thread only
+  uint64_t dropped_pending_entries_;   // lost without spool: over pending_max_entries or at exit
+  common::libev::timer_id_t connection_timer_;
+  common::time64_t reconnect_delay_;  // msec, grows after each failed attempt
+  common::time64_t reconnect_at_;     // msec, next attempt while disconnected
+  bool master_activated_;  // activation of inner_connection_ accepted
+  EntrySpool* spool_;      // NULL if spool_dir is not configured
+  common::libev::timer_id_t spool_timer_;
+  std::string entries_encoding_;                    // accepted by master on activation, json until then
+  std::string uplink_dictionary_;                   // trained on earlier connection, resent to master
+  protocol::CompressionStats closed_uplink_stats_;  // of connections closed before current one
+  commands_info::StatsInfo stats_;                           // last sampled, loop thread only
+  uint64_t sent_entries_;                                    // written to master, loop thread only
+  uint64_t sampled_sent_entries_;                            // sent_entries_ at last sample
+  std::atomic<uint64_t> parse_results_[PARSE_RESULTS_COUNT];  // written by loop and capture workers
 };
 }
 }
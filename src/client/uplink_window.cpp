@@ -0,0 +1,110 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "client/uplink_window.h"
+
+#include <algorithm>
+
+namespace sniffer {
+namespace client {
+
+UplinkWindow::UplinkWindow(size_t max_batches)
+    : max_batches_(std::max<size_t>(max_batches, 1)), inflight_(), rtts_(), rtt_next_(0) {}
+
+bool UplinkWindow::IsFull() const {
+  return inflight_.size() >= max_batches_;
+}
+
+bool UplinkWindow::IsEmpty() const {
+  return inflight_.empty();
+}
+
+size_t UplinkWindow::GetInflightCount() const {
+  return inflight_.size();
+}
+
+size_t UplinkWindow::GetMaxBatches() const {
+  return max_batches_;
+}
+
+void UplinkWindow::SetMaxBatches(size_t max_batches) {
+  max_batches_ = std::max<size_t>(max_batches, 1);
+}
+
+void UplinkWindow::Add(const protocol::sequance_id_t& id,
+                       const EntryInfo* entries,
+                       size_t count,
+                       common::time64_t now_msec) {
+  Batch& batch = inflight_[id];
+  batch.entries.assign(entries, entries + count);
+  batch.sent_msec = now_msec;
+}
+
+bool UplinkWindow::Ack(const protocol::sequance_id_t& id, common::time64_t now_msec) {
+  auto it = inflight_.find(id);
+  if (it == inflight_.end()) {
+    return false;
+  }
+
+  const common::time64_t rtt = std::max<common::time64_t>(now_msec - it->second.sent_msec, 0);
+  if (rtts_.size() < rtt_samples) {
+    rtts_.push_back(rtt);
+  } else {
+    rtts_[rtt_next_] = rtt;
+    rtt_next_ = (rtt_next_ + 1) % rtt_samples;
+  }
+  inflight_.erase(it);
+  return true;
+}
+
+bool UplinkWindow::Reject(const protocol::sequance_id_t& id, std::vector<EntryInfo>* entries) {
+  auto it = inflight_.find(id);
+  if (it == inflight_.end()) {
+    return false;
+  }
+
+  entries->insert(entries->end(), it->second.entries.begin(), it->second.entries.end());
+  inflight_.erase(it);
+  return true;
+}
+
+common::time64_t UplinkWindow::GetOldestSentTime() const {
+  if (inflight_.empty()) {
+    return 0;
+  }
+  return inflight_.begin()->second.sent_msec;
+}
+
+void UplinkWindow::TakeAll(std::vector<EntryInfo>* entries) {
+  for (auto it = inflight_.begin(); it != inflight_.end(); ++it) {
+    entries->insert(entries->end(), it->second.entries.begin(), it->second.entries.end());
+  }
+  inflight_.clear();
+}
+
+common::time64_t UplinkWindow::GetRttPercentile(unsigned percentile) const {
+  if (rtts_.empty()) {
+    return 0;
+  }
+
+  // nearest rank, sampled every stats interval so copy is cheaper than keeping order
+  std::vector<common::time64_t> sorted = rtts_;
+  const size_t rank = std::min<size_t>(sorted.size() * std::min(percentile, 100u) / 100, sorted.size() - 1);
+  std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+  return sorted[rank];
+}
+
+}  // namespace client
+}  // namespace sniffer
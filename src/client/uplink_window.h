@@ -0,0 +1,69 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include <common/macros.h>
+#include <common/types.h>
+
+#include "protocol/types.h"
+
+#include "entry_info.h"
+
+namespace sniffer {
+namespace client {
+
+// entries requests written to master and not yet acknowledged, keyed by request id,
+// ids of NextRequestID are fixed width hex of growing counter so map order is send order
+class UplinkWindow {
+ public:
+  enum { default_max_batches = 16, rtt_samples = 1024 };
+
+  explicit UplinkWindow(size_t max_batches);
+
+  bool IsFull() const;
+  bool IsEmpty() const;
+  size_t GetInflightCount() const;  // batches
+  size_t GetMaxBatches() const;
+  void SetMaxBatches(size_t max_batches);
+
+  void Add(const protocol::sequance_id_t& id, const EntryInfo* entries, size_t count, common::time64_t now_msec);
+  bool Ack(const protocol::sequance_id_t& id, common::time64_t now_msec);  // false for ids not in window
+  // master answered fail, entries of request are appended for requeue
+  bool Reject(const protocol::sequance_id_t& id, std::vector<EntryInfo>* entries);
+  common::time64_t GetOldestSentTime() const;                               // msec, 0 if empty
+  void TakeAll(std::vector<EntryInfo>* entries);                            // unacknowledged, in send order
+
+  common::time64_t GetRttPercentile(unsigned percentile) const;  // msec over last rtt_samples acks, 0 without acks
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(UplinkWindow);
+
+  struct Batch {
+    std::vector<EntryInfo> entries;
+    common::time64_t sent_msec;
+  };
+
+  size_t max_batches_;
+  std::map<protocol::sequance_id_t, Batch> inflight_;
+  std::vector<common::time64_t> rtts_;  // ring of recent samples
+  size_t rtt_next_;
+};
+
+}  // namespace client
+}  // namespace sniffer
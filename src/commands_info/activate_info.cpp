@@ -17,6 +17,8 @@
 #define ACTIVATE_INFO_TYPE_FIELD "type"
 
 #define ACTIVATE_SLAVE_INFO_ID_FIELD "id"
+#define ACTIVATE_SLAVE_INFO_ENTRIES_ENCODING_FIELD "entries_encoding"
+#define ACTIVATE_SLAVE_INFO_COMPRESSION_FIELD "compression"
 
 namespace sniffer {
 namespace commands_info {
@@ -27,7 +29,10 @@ ActivateInfo::ActivateInfo(const std::string& license) : base_class(license) {}
 
 // ActivateSlaveInfo
 
-ActivateSlaveInfo::ActivateSlaveInfo() : base_class(), id_() {}
+ActivateSlaveInfo::ActivateSlaveInfo() : base_class(), id_(), entries_encoding_(), compression_() {}
+
+ActivateSlaveInfo::ActivateSlaveInfo(const std::string& license, const id_t& id)
+    : base_class(license), id_(id), entries_encoding_(), compression_() {}
 
 bool ActivateSlaveInfo::IsValid() const {
   return base_class::IsValid() && !id_.empty();
@@ -52,6 +57,54 @@ bool ActivateSlaveInfo::GetID(json_object* serialized, id_t* id) {
   return true;
 }
 
+std::string ActivateSlaveInfo::GetEntriesEncoding() const {
+  return entries_encoding_;
+}
+
+void ActivateSlaveInfo::SetEntriesEncoding(const std::string& encoding) {
+  entries_encoding_ = encoding;
+}
+
+bool ActivateSlaveInfo::GetEntriesEncoding(json_object* serialized, std::string* encoding) {
+  if (!serialized || !encoding) {
+    return false;
+  }
+
+  json_object* jencoding = NULL;
+  json_bool jencoding_exists =
+      json_object_object_get_ex(serialized, ACTIVATE_SLAVE_INFO_ENTRIES_ENCODING_FIELD, &jencoding);
+  if (!jencoding_exists) {
+    return false;
+  }
+
+  *encoding = json_object_get_string(jencoding);
+  return true;
+}
+
+std::string ActivateSlaveInfo::GetCompression() const {
+  return compression_;
+}
+
+void ActivateSlaveInfo::SetCompression(const std::string& compression) {
+  compression_ = compression;
+}
+
+bool ActivateSlaveInfo::GetCompression(json_object* serialized, std::string* compression) {
+  if (!serialized || !compression) {
+    return false;
+  }
+
+  json_object* jcompression = NULL;
+  json_bool jcompression_exists =
+      json_object_object_get_ex(serialized, ACTIVATE_SLAVE_INFO_COMPRESSION_FIELD, &jcompression);
+  if (!jcompression_exists) {
+    return false;
+  }
+
+  *compression = json_object_get_string(jcompression);
+  return true;
+}
+
 common::Error ActivateSlaveInfo::DoDeSerialize(json_object* serialized) {
   ActivateSlaveInfo inf;
   common::Error err = inf.base_class::DoDeSerialize(serialized);
@@ -64,6 +117,14 @@ common::Error ActivateSlaveInfo::DoDeSerialize(json_object* serialized) {
     return common::make_error_inval();
   }
 
+  if (!GetEntriesEncoding(serialized, &inf.entries_encoding_)) {
+    inf.entries_encoding_.clear();
+  }
+
+  if (!GetCompression(serialized, &inf.compression_)) {
+    inf.compression_.clear();
+  }
+
   *this = inf;
   return common::Error();
 }
@@ -71,6 +132,13 @@ common::Error ActivateSlaveInfo::DoDeSerialize(json_object* serialized) {
 common::Error ActivateSlaveInfo::SerializeFields(json_object* obj) const {
   DCHECK(IsValid());
   json_object_object_add(obj, ACTIVATE_SLAVE_INFO_ID_FIELD, json_object_new_string(id_.c_str()));
+  if (!entries_encoding_.empty()) {
+    json_object_object_add(obj, ACTIVATE_SLAVE_INFO_ENTRIES_ENCODING_FIELD,
+                           json_object_new_string(entries_encoding_.c_str()));
+  }
+  if (!compression_.empty()) {
+    json_object_object_add(obj, ACTIVATE_SLAVE_INFO_COMPRESSION_FIELD, json_object_new_string(compression_.c_str()));
+  }
   return base_class::SerializeFields(obj);
 }
 
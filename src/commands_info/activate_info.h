@@ -32,18 +32,31 @@ class ActivateSlaveInfo : public ActivateInfo {
   typedef std::string id_t;
 
   ActivateSlaveInfo();
+  ActivateSlaveInfo(const std::string& license, const id_t& id);
 
   bool IsValid() const;
 
   id_t GetID() const;
   static bool GetID(json_object* serialized, id_t* id);
 
+  // encoding of entries preferred by slave, optional, old slaves send only json
+  std::string GetEntriesEncoding() const;
+  void SetEntriesEncoding(const std::string& encoding);
+  static bool GetEntriesEncoding(json_object* serialized, std::string* encoding);
+
+  // frame compression preferred by slave, optional
+  std::string GetCompression() const;
+  void SetCompression(const std::string& compression);
+  static bool GetCompression(json_object* serialized, std::string* compression);
+
  protected:
   virtual common::Error DoDeSerialize(json_object* serialized) override;
   virtual common::Error SerializeFields(json_object* obj) const override;
 
  private:
   id_t id_;
+  std::string entries_encoding_;
+  std::string compression_;
 };
 }
 }
@@ -0,0 +1,289 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "commands_info/entries_binary.h"
+
+#include <map>
+
+#define ENTRIES_BINARY_VERSION 1
+
+namespace sniffer {
+namespace commands_info {
+namespace {
+
+const char kBase64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+void Base64Encode(const std::string& bytes, std::string* out) {
+  out->reserve(out->size() + (bytes.size() + 2) / 3 * 4);
+  const unsigned char* in = reinterpret_cast<const unsigned char*>(bytes.data());
+  size_t i = 0;
+  for (; i + 2 < bytes.size(); i += 3) {
+    const uint32_t triple = (in[i] << 16) | (in[i + 1] << 8) | in[i + 2];
+    out->push_back(kBase64Alphabet[(triple >> 18) & 0x3F]);
+    out->push_back(kBase64Alphabet[(triple >> 12) & 0x3F]);
+    out->push_back(kBase64Alphabet[(triple >> 6) & 0x3F]);
+    out->push_back(kBase64Alphabet[triple & 0x3F]);
+  }
+
+  const size_t rest = bytes.size() - i;
+  if (rest) {
+    const uint32_t triple = (in[i] << 16) | (rest == 2 ? in[i + 1] << 8 : 0);
+    out->push_back(kBase64Alphabet[(triple >> 18) & 0x3F]);
+    out->push_back(kBase64Alphabet[(triple >> 12) & 0x3F]);
+    out->push_back(rest == 2 ? kBase64Alphabet[(triple >> 6) & 0x3F] : '=');
+    out->push_back('=');
+  }
+}
+
+int Base64Value(char c) {
+  if (c >= 'A' && c <= 'Z') {
+    return c - 'A';
+  } else if (c >= 'a' && c <= 'z') {
+    return c - 'a' + 26;
+  } else if (c >= '0' && c <= '9') {
+    return c - '0' + 52;
+  } else if (c == '+') {
+    return 62;
+  } else if (c == '/') {
+    return 63;
+  }
+  return -1;
+}
+
+bool Base64Decode(const char* data, size_t size, std::string* out) {
+  if (size % 4 != 0) {
+    return false;
+  }
+
+  out->reserve(size / 4 * 3);
+  for (size_t i = 0; i < size; i += 4) {
+    const bool last = i + 4 == size;
+    const size_t pad = last ? (data[i + 3] == '=') + (data[i + 2] == '=') : 0;
+    uint32_t quad = 0;
+    for (size_t j = 0; j < 4 - pad; ++j) {
+      const int value = Base64Value(data[i + j]);
+      if (value < 0) {
+        return false;
+      }
+      quad |= value << (18 - 6 * j);
+    }
+
+    out->push_back(static_cast<char>(quad >> 16));
+    if (pad < 2) {
+      out->push_back(static_cast<char>(quad >> 8));
+    }
+    if (pad < 1) {
+      out->push_back(static_cast<char>(quad));
+    }
+  }
+  return true;
+}
+
+void PutVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+void PutSignedVarint(int64_t value, std::string* out) {
+  PutVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63), out);
+}
+
+class BinaryReader {
+ public:
+  explicit BinaryReader(const std::string& data)
+      : pos_(reinterpret_cast<const uint8_t*>(data.data())), end_(pos_ + data.size()) {}
+
+  size_t GetRemaining() const { return end_ - pos_; }
+
+  bool GetByte(uint8_t* value) {
+    if (pos_ == end_) {
+      return false;
+    }
+    *value = *pos_++;
+    return true;
+  }
+
+  bool GetBytes(size_t size, const uint8_t** bytes) {
+    if (GetRemaining() < size) {
+      return false;
+    }
+    *bytes = pos_;
+    pos_ += size;
+    return true;
+  }
+
+  bool GetVarint(uint64_t* value) {
+    uint64_t result = 0;
+    for (unsigned shift = 0; shift < 64 && pos_ != end_; shift += 7) {
+      const uint8_t byte = *pos_++;
+      result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if (!(byte & 0x80)) {
+        *value = result;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool GetSignedVarint(int64_t* value) {
+    uint64_t zigzag;
+    if (!GetVarint(&zigzag)) {
+      return false;
+    }
+    *value = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+    return true;
+  }
+
+ private:
+  const uint8_t* pos_;
+  const uint8_t* end_;
+};
+
+enum { min_binary_entry_size = SIZE_OF_MAC_ADDRESS + 4 };
+
+}  // namespace
+
+void EncodeEntriesBinary(const EntryInfo* entries, size_t count, std::string* out) {
+  std::map<std::string, size_t> iface_indexes;
+  std::vector<std::string> ifaces;
+  for (size_t i = 0; i < count; ++i) {
+    const std::string iface = entries[i].GetIface();
+    if (!iface.empty() && iface_indexes.insert(std::make_pair(iface, ifaces.size())).second) {
+      ifaces.push_back(iface);
+    }
+  }
+
+  std::string bytes;
+  bytes.reserve(16 + count * (min_binary_entry_size + 2));
+  bytes.push_back(ENTRIES_BINARY_VERSION);
+  PutVarint(ifaces.size(), &bytes);
+  for (size_t i = 0; i < ifaces.size(); ++i) {
+    PutVarint(ifaces[i].size(), &bytes);
+    bytes.append(ifaces[i]);
+  }
+
+  PutVarint(count, &bytes);
+  common::time64_t prev_ts = count ? entries[0].GetTimestamp() : 0;
+  PutSignedVarint(prev_ts, &bytes);
+  for (size_t i = 0; i < count; ++i) {
+    const EntryInfo& ent = entries[i];
+    mac_address_t mac;
+    ent.GetMacAddress().ToBytes(mac);
+    bytes.append(reinterpret_cast<const char*>(mac), SIZE_OF_MAC_ADDRESS);
+
+    const common::time64_t ts = ent.GetTimestamp();
+    PutSignedVarint(ts - prev_ts, &bytes);
+    prev_ts = ts;
+
+    bytes.push_back(static_cast<char>(ent.GetSSI()));
+    const uint32_t ent_count = ent.GetCount();
+    PutVarint(ent_count, &bytes);
+    if (ent_count != 1) {
+      bytes.push_back(static_cast<char>(ent.GetMinSSI()));
+      bytes.push_back(static_cast<char>(ent.GetMaxSSI()));
+    }
+
+    const std::string iface = ent.GetIface();
+    PutVarint(iface.empty() ? 0 : iface_indexes[iface] + 1, &bytes);
+  }
+
+  Base64Encode(bytes, out);
+}
+
+common::Error DecodeEntriesBinary(const char* data, size_t size, std::vector<EntryInfo>* entries) {
+  if (!data || !entries) {
+    DNOTREACHED();
+    return common::make_error_inval();
+  }
+
+  std::string bytes;
+  if (!Base64Decode(data, size, &bytes)) {
+    return common::make_error("Invalid base64 entries");
+  }
+
+  BinaryReader reader(bytes);
+  uint8_t version;
+  if (!reader.GetByte(&version) || version != ENTRIES_BINARY_VERSION) {
+    return common::make_error("Unsupported binary entries version");
+  }
+
+  uint64_t iface_count;
+  if (!reader.GetVarint(&iface_count) || iface_count > reader.GetRemaining()) {
+    return common::make_error_inval();
+  }
+
+  std::vector<std::string> ifaces;
+  ifaces.reserve(iface_count);
+  for (uint64_t i = 0; i < iface_count; ++i) {
+    uint64_t len;
+    const uint8_t* name;
+    if (!reader.GetVarint(&len) || len > reader.GetRemaining() || !reader.GetBytes(len, &name)) {
+      return common::make_error_inval();
+    }
+    ifaces.push_back(std::string(reinterpret_cast<const char*>(name), len));
+  }
+
+  uint64_t count;
+  int64_t ts;
+  if (!reader.GetVarint(&count) || !reader.GetSignedVarint(&ts) ||
+      count > reader.GetRemaining() / min_binary_entry_size) {
+    return common::make_error_inval();
+  }
+
+  std::vector<EntryInfo> result;
+  result.reserve(count);
+  for (uint64_t i = 0; i < count; ++i) {
+    const uint8_t* mac;
+    int64_t delta;
+    uint8_t ssi;
+    uint64_t ent_count;
+    if (!reader.GetBytes(SIZE_OF_MAC_ADDRESS, &mac) || !reader.GetSignedVarint(&delta) || !reader.GetByte(&ssi) ||
+        !reader.GetVarint(&ent_count) || ent_count == 0 || ent_count > UINT32_MAX) {
+      return common::make_error_inval();
+    }
+
+    uint8_t ssi_min = ssi;
+    uint8_t ssi_max = ssi;
+    if (ent_count != 1 && (!reader.GetByte(&ssi_min) || !reader.GetByte(&ssi_max))) {
+      return common::make_error_inval();
+    }
+
+    uint64_t iface_index;
+    if (!reader.GetVarint(&iface_index) || iface_index > ifaces.size()) {
+      return common::make_error_inval();
+    }
+
+    ts += delta;
+    EntryInfo ent(MacAddress(mac), ts, static_cast<int8_t>(ssi));
+    ent.SetAggregate(ent_count, static_cast<int8_t>(ssi_min), static_cast<int8_t>(ssi_max));
+    if (iface_index) {
+      ent.SetIface(ifaces[iface_index - 1]);
+    }
+    result.push_back(ent);
+  }
+
+  if (reader.GetRemaining()) {
+    return common::make_error("Trailing bytes after binary entries");
+  }
+
+  *entries = result;
+  return common::Error();
+}
+
+}  // namespace commands_info
+}  // namespace sniffer
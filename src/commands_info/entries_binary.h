@@ -0,0 +1,44 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <common/error.h>
+#include <common/macros.h>
+
+#include "entry_info.h"
+
+// values of "entries_encoding" in slave activation and in its responce
+#define ENTRIES_ENCODING_JSON "json"
+#define ENTRIES_ENCODING_BINARY "binary"
+
+namespace sniffer {
+namespace commands_info {
+
+/*
+  Compact uplink form of entries, base64 text so it passes as single command argument:
+  u8 version, varint iface count, ifaces as varint length + bytes, varint entry count,
+  zigzag varint timestamp of first entry, then per entry:
+  6 bytes mac in wire order, zigzag varint timestamp delta, i8 ssi, varint count,
+  i8 ssi_min and i8 ssi_max only when count != 1, varint iface index + 1 (0 - no iface).
+*/
+void EncodeEntriesBinary(const EntryInfo* entries, size_t count, std::string* out);
+common::Error DecodeEntriesBinary(const char* data, size_t size, std::vector<EntryInfo>* entries) WARN_UNUSED_RESULT;
+
+}  // namespace commands_info
+}  // namespace sniffer
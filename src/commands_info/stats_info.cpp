@@ -0,0 +1,209 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "commands_info/stats_info.h"
+
+#define STATS_INFO_ID_FIELD "id"
+#define STATS_INFO_TIMESTAMP_FIELD "timestamp"
+#define STATS_INFO_CAPTURE_FIELD "capture"
+#define STATS_INFO_PARSE_FIELD "parse"
+#define STATS_INFO_UPLINK_FIELD "uplink"
+
+#define CAPTURE_RECEIVED_FIELD "received"
+#define CAPTURE_DROPPED_FIELD "dropped"
+#define CAPTURE_IF_DROPPED_FIELD "if_dropped"
+
+#define UPLINK_RAW_BYTES_FIELD "raw_bytes"
+#define UPLINK_WIRE_BYTES_FIELD "wire_bytes"
+#define UPLINK_COMPRESSED_FRAMES_FIELD "compressed_frames"
+#define UPLINK_INFLIGHT_FIELD "inflight"
+#define UPLINK_RETRANSMITTED_FIELD "retransmitted"
+#define UPLINK_DROPPED_FIELD "dropped"
+#define UPLINK_RTT_P50_FIELD "rtt_p50"
+#define UPLINK_RTT_P90_FIELD "rtt_p90"
+#define UPLINK_RTT_P99_FIELD "rtt_p99"
+
+namespace sniffer {
+namespace commands_info {
+
+UplinkAckStats::UplinkAckStats() : inflight(0), retransmitted(0), dropped(0), rtt_p50(0), rtt_p90(0), rtt_p99(0) {}
+
+StatsInfo::StatsInfo() : id_(), timestamp_(0), captures_(), parse_(), uplink_(), uplink_acks_() {}
+
+StatsInfo::StatsInfo(const id_t& id, common::time64_t ts, const captures_t& captures, const ParseStats& parse)
+    : id_(id), timestamp_(ts), captures_(captures), parse_(parse), uplink_(), uplink_acks_() {}
+
+StatsInfo::id_t StatsInfo::GetID() const {
+  return id_;
+}
+
+common::time64_t StatsInfo::GetTimestamp() const {
+  return timestamp_;
+}
+
+StatsInfo::captures_t StatsInfo::GetCaptures() const {
+  return captures_;
+}
+
+StatsInfo::capture_t StatsInfo::GetTotalCapture() const {
+  capture_t total;
+  for (size_t i = 0; i < captures_.size(); ++i) {
+    total.received += captures_[i].received;
+    total.dropped += captures_[i].dropped;
+    total.if_dropped += captures_[i].if_dropped;
+  }
+  return total;
+}
+
+ParseStats StatsInfo::GetParseStats() const {
+  return parse_;
+}
+
+protocol::CompressionStats StatsInfo::GetUplink() const {
+  return uplink_;
+}
+
+void StatsInfo::SetUplink(const protocol::CompressionStats& uplink) {
+  uplink_ = uplink;
+}
+
+UplinkAckStats StatsInfo::GetUplinkAcks() const {
+  return uplink_acks_;
+}
+
+void StatsInfo::SetUplinkAcks(const UplinkAckStats& acks) {
+  uplink_acks_ = acks;
+}
+
+common::Error StatsInfo::DoDeSerialize(json_object* serialized) {
+  StatsInfo inf;
+  json_object* jid = NULL;
+  json_bool jid_exists = json_object_object_get_ex(serialized, STATS_INFO_ID_FIELD, &jid);
+  if (jid_exists) {
+    inf.id_ = json_object_get_string(jid);
+  }
+
+  json_object* jtimestamp = NULL;
+  json_bool jtimestamp_exists = json_object_object_get_ex(serialized, STATS_INFO_TIMESTAMP_FIELD, &jtimestamp);
+  if (jtimestamp_exists) {
+    inf.timestamp_ = json_object_get_int64(jtimestamp);
+  }
+
+  json_object* jcapture = NULL;
+  json_bool jcapture_exists = json_object_object_get_ex(serialized, STATS_INFO_CAPTURE_FIELD, &jcapture);
+  if (jcapture_exists) {
+    size_t len = json_object_array_length(jcapture);
+    for (size_t i = 0; i < len; ++i) {
+      json_object* jworker = json_object_array_get_idx(jcapture, i);
+      capture_t worker;
+      json_object* jfield = NULL;
+      if (json_object_object_get_ex(jworker, CAPTURE_RECEIVED_FIELD, &jfield)) {
+        worker.received = json_object_get_int64(jfield);
+      }
+      if (json_object_object_get_ex(jworker, CAPTURE_DROPPED_FIELD, &jfield)) {
+        worker.dropped = json_object_get_int64(jfield);
+      }
+      if (json_object_object_get_ex(jworker, CAPTURE_IF_DROPPED_FIELD, &jfield)) {
+        worker.if_dropped = json_object_get_int64(jfield);
+      }
+      inf.captures_.push_back(worker);
+    }
+  }
+
+  json_object* jparse = NULL;
+  json_bool jparse_exists = json_object_object_get_ex(serialized, STATS_INFO_PARSE_FIELD, &jparse);
+  if (jparse_exists) {
+    for (int i = 0; i < PARSE_RESULTS_COUNT; ++i) {
+      json_object* jresult = NULL;
+      if (json_object_object_get_ex(jparse, ParseResultToString(static_cast<PARSE_RESULT>(i)), &jresult)) {
+        inf.parse_.results[i] = json_object_get_int64(jresult);
+      }
+    }
+  }
+
+  json_object* juplink = NULL;
+  json_bool juplink_exists = json_object_object_get_ex(serialized, STATS_INFO_UPLINK_FIELD, &juplink);
+  if (juplink_exists) {
+    json_object* jfield = NULL;
+    if (json_object_object_get_ex(juplink, UPLINK_RAW_BYTES_FIELD, &jfield)) {
+      inf.uplink_.raw_bytes = json_object_get_int64(jfield);
+    }
+    if (json_object_object_get_ex(juplink, UPLINK_WIRE_BYTES_FIELD, &jfield)) {
+      inf.uplink_.wire_bytes = json_object_get_int64(jfield);
+    }
+    if (json_object_object_get_ex(juplink, UPLINK_COMPRESSED_FRAMES_FIELD, &jfield)) {
+      inf.uplink_.compressed_frames = json_object_get_int64(jfield);
+    }
+    if (json_object_object_get_ex(juplink, UPLINK_INFLIGHT_FIELD, &jfield)) {
+      inf.uplink_acks_.inflight = json_object_get_int64(jfield);
+    }
+    if (json_object_object_get_ex(juplink, UPLINK_RETRANSMITTED_FIELD, &jfield)) {
+      inf.uplink_acks_.retransmitted = json_object_get_int64(jfield);
+    }
+    if (json_object_object_get_ex(juplink, UPLINK_DROPPED_FIELD, &jfield)) {
+      inf.uplink_acks_.dropped = json_object_get_int64(jfield);
+    }
+    if (json_object_object_get_ex(juplink, UPLINK_RTT_P50_FIELD, &jfield)) {
+      inf.uplink_acks_.rtt_p50 = json_object_get_int64(jfield);
+    }
+    if (json_object_object_get_ex(juplink, UPLINK_RTT_P90_FIELD, &jfield)) {
+      inf.uplink_acks_.rtt_p90 = json_object_get_int64(jfield);
+    }
+    if (json_object_object_get_ex(juplink, UPLINK_RTT_P99_FIELD, &jfield)) {
+      inf.uplink_acks_.rtt_p99 = json_object_get_int64(jfield);
+    }
+  }
+
+  *this = inf;
+  return common::Error();
+}
+
+common::Error StatsInfo::SerializeFields(json_object* deserialized) const {
+  json_object_object_add(deserialized, STATS_INFO_ID_FIELD, json_object_new_string(id_.c_str()));
+  json_object_object_add(deserialized, STATS_INFO_TIMESTAMP_FIELD, json_object_new_int64(timestamp_));
+
+  json_object* jcapture = json_object_new_array();
+  for (size_t i = 0; i < captures_.size(); ++i) {
+    json_object* jworker = json_object_new_object();
+    json_object_object_add(jworker, CAPTURE_RECEIVED_FIELD, json_object_new_int64(captures_[i].received));
+    json_object_object_add(jworker, CAPTURE_DROPPED_FIELD, json_object_new_int64(captures_[i].dropped));
+    json_object_object_add(jworker, CAPTURE_IF_DROPPED_FIELD, json_object_new_int64(captures_[i].if_dropped));
+    json_object_array_add(jcapture, jworker);
+  }
+  json_object_object_add(deserialized, STATS_INFO_CAPTURE_FIELD, jcapture);
+
+  json_object* jparse = json_object_new_object();
+  for (int i = 0; i < PARSE_RESULTS_COUNT; ++i) {
+    json_object_object_add(jparse, ParseResultToString(static_cast<PARSE_RESULT>(i)),
+                           json_object_new_int64(parse_.results[i]));
+  }
+  json_object_object_add(deserialized, STATS_INFO_PARSE_FIELD, jparse);
+
+  json_object* juplink = json_object_new_object();
+  json_object_object_add(juplink, UPLINK_RAW_BYTES_FIELD, json_object_new_int64(uplink_.raw_bytes));
+  json_object_object_add(juplink, UPLINK_WIRE_BYTES_FIELD, json_object_new_int64(uplink_.wire_bytes));
+  json_object_object_add(juplink, UPLINK_COMPRESSED_FRAMES_FIELD, json_object_new_int64(uplink_.compressed_frames));
+  json_object_object_add(juplink, UPLINK_INFLIGHT_FIELD, json_object_new_int64(uplink_acks_.inflight));
+  json_object_object_add(juplink, UPLINK_RETRANSMITTED_FIELD, json_object_new_int64(uplink_acks_.retransmitted));
+  json_object_object_add(juplink, UPLINK_DROPPED_FIELD, json_object_new_int64(uplink_acks_.dropped));
+  json_object_object_add(juplink, UPLINK_RTT_P50_FIELD, json_object_new_int64(uplink_acks_.rtt_p50));
+  json_object_object_add(juplink, UPLINK_RTT_P90_FIELD, json_object_new_int64(uplink_acks_.rtt_p90));
+  json_object_object_add(juplink, UPLINK_RTT_P99_FIELD, json_object_new_int64(uplink_acks_.rtt_p99));
+  json_object_object_add(deserialized, STATS_INFO_UPLINK_FIELD, juplink);
+  return common::Error();
+}
+
+}  // namespace commands_info
+}
@@ -0,0 +1,78 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <vector>
+
+#include <common/serializer/json_serializer.h>
+
+#include <common/types.h>
+
+#include "protocol/frame_codec.h"
+
+#include "sniffer/isniffer.h"
+
+#include "utils.h"
+
+namespace sniffer {
+namespace commands_info {
+
+struct UplinkAckStats {
+  UplinkAckStats();
+
+  uint64_t inflight;         // entries requests waiting for master ack
+  uint64_t retransmitted;    // entries sent again after connection loss
+  uint64_t dropped;          // entries never delivered: spool or pending caps, exit without spool
+  common::time64_t rtt_p50;  // msec from write to ack
+  common::time64_t rtt_p90;
+  common::time64_t rtt_p99;
+};
+
+class StatsInfo : public common::serializer::JsonSerializer<StatsInfo> {
+ public:
+  typedef std::string id_t;
+  typedef sniffer::CaptureStats capture_t;
+  typedef std::vector<capture_t> captures_t;  // per capture worker
+
+  StatsInfo();
+  StatsInfo(const id_t& id, common::time64_t ts, const captures_t& captures, const ParseStats& parse);
+
+  id_t GetID() const;
+  common::time64_t GetTimestamp() const;  // msec
+  captures_t GetCaptures() const;
+  capture_t GetTotalCapture() const;
+  ParseStats GetParseStats() const;
+
+  protocol::CompressionStats GetUplink() const;  // bytes of commands and of frames sent to master
+  void SetUplink(const protocol::CompressionStats& uplink);
+  UplinkAckStats GetUplinkAcks() const;
+  void SetUplinkAcks(const UplinkAckStats& acks);
+
+ protected:
+  virtual common::Error DoDeSerialize(json_object* serialized) override;
+  virtual common::Error SerializeFields(json_object* deserialized) const override;
+
+ private:
+  id_t id_;
+  common::time64_t timestamp_;
+  captures_t captures_;
+  ParseStats parse_;
+  protocol::CompressionStats uplink_;
+  UplinkAckStats uplink_acks_;
+};
+
+}  // namespace commands_info
+}
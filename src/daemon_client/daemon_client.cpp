@@ -18,7 +18,7 @@ namespace sniffer {
 namespace daemon_client {
 
 DaemonClient::DaemonClient(common::libev::IoLoop* server, const common::net::socket_info& info)
-    : base_class(server, info), is_verified_(false) {}
+    : base_class(server, info), is_verified_(false), slave_id_(), codec_() {}
 
 DaemonClient::~DaemonClient() {}
 
@@ -30,6 +30,18 @@ void DaemonClient::SetVerified(bool verif) {
   is_verified_ = verif;
 }
 
+std::string DaemonClient::GetSlaveID() const {
+  return slave_id_;
+}
+
+void DaemonClient::SetSlaveID(const std::string& id) {
+  slave_id_ = id;
+}
+
+protocol::FrameCodec* DaemonClient::GetFrameCodec() {
+  return &codec_;
+}
+
 const char* DaemonClient::ClassName() const {
   return "DaemonClient";
 }
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <string>
+
 #include <common/libev/tcp/tcp_client.h>  // for TcpClient
 
 #include "protocol/protocol.h"
@@ -30,10 +32,17 @@ class DaemonClient : public common::libev::tcp::TcpClient {
   bool IsVerified() const;
   void SetVerified(bool verif);
 
+  std::string GetSlaveID() const;  // id sent on activation by slave, empty for other clients
+  void SetSlaveID(const std::string& id);
+
+  protocol::FrameCodec* GetFrameCodec();  // compression state of this connection
+
   const char* ClassName() const override;
 
  private:
   bool is_verified_;
+  std::string slave_id_;
+  protocol::FrameCodec codec_;
 };
 
 typedef protocol::ProtocolClient<DaemonClient> ProtocoledDaemonClient;
@@ -19,6 +19,11 @@
 #define CLIENT_STOP_SERVICE_RESP_FAIL_1E GENEATATE_FAIL_FMT(CLIENT_STOP_SERVICE, "'%s'")
 #define CLIENT_STOP_SERVICE_RESP_SUCCESS GENEATATE_SUCCESS(CLIENT_STOP_SERVICE)
 
+// get stats
+#define CLIENT_GET_STATS_REQ_1E GENERATE_REQUEST_FMT_ARGS(CLIENT_GET_STATS, "'%s'")
+#define CLIENT_GET_STATS_RESP_FAIL_1E GENEATATE_FAIL_FMT(CLIENT_GET_STATS, "'%s'")
+#define CLIENT_GET_STATS_RESP_SUCCESS_1E GENEATATE_SUCCESS_FMT(CLIENT_GET_STATS, "'%s'")
+
 namespace sniffer {
 namespace daemon_client {
 
@@ -34,5 +39,17 @@ protocol::request_t StopServiceRequest(protocol::sequance_id_t id, protocol::ser
   return common::protocols::three_way_handshake::MakeRequest(id, CLIENT_STOP_SERVICE_REQ_1E, msg);
 }
 
+protocol::responce_t GetStatsResponceSuccess(protocol::sequance_id_t id, protocol::serializet_t stats) {
+  return common::protocols::three_way_handshake::MakeResponce(id, CLIENT_GET_STATS_RESP_SUCCESS_1E, stats);
+}
+
+protocol::responce_t GetStatsResponceFail(protocol::sequance_id_t id, const std::string& error_text) {
+  return common::protocols::three_way_handshake::MakeResponce(id, CLIENT_GET_STATS_RESP_FAIL_1E, error_text);
+}
+
+protocol::request_t GetStatsRequest(protocol::sequance_id_t id, protocol::serializet_t msg) {
+  return common::protocols::three_way_handshake::MakeRequest(id, CLIENT_GET_STATS_REQ_1E, msg);
+}
+
 }  // namespace server
 }
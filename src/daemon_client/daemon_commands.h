@@ -20,6 +20,7 @@
 // client commands
 
 #define CLIENT_STOP_SERVICE "stop_service"  // {"delay": 0 }
+#define CLIENT_GET_STATS "get_stats"        // {"license_key": "XXXXXXXXXXXXXXXXXX"}
 
 namespace sniffer {
 namespace daemon_client {
@@ -29,5 +30,10 @@ protocol::responce_t StopServiceResponceFail(protocol::sequance_id_t id, const s
 
 protocol::request_t StopServiceRequest(protocol::sequance_id_t id, protocol::serializet_t msg);
 
+protocol::responce_t GetStatsResponceSuccess(protocol::sequance_id_t id, protocol::serializet_t stats);
+protocol::responce_t GetStatsResponceFail(protocol::sequance_id_t id, const std::string& error_text);
+
+protocol::request_t GetStatsRequest(protocol::sequance_id_t id, protocol::serializet_t msg);
+
 }  // namespace server
 }
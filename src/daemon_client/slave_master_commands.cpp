@@ -15,8 +15,10 @@
 #include "daemon_client/slave_master_commands.h"
 
 // activate
+#define SLAVE_ACTIVATE_REQ_1E GENERATE_REQUEST_FMT_ARGS(SLAVE_ACTIVATE, "'%s'")
 #define SLAVE_ACTIVATE_RESP_FAIL_1E GENEATATE_FAIL_FMT(SLAVE_ACTIVATE, "%s")
 #define SLAVE_ACTIVATE_RESP_SUCCESS GENEATATE_SUCCESS(SLAVE_ACTIVATE)
+#define SLAVE_ACTIVATE_RESP_SUCCESS_2E GENEATATE_SUCCESS_FMT(SLAVE_ACTIVATE, "%s %s")
 
 // entry
 #define SLAVE_SEND_ENTRY_REQ_1E GENERATE_REQUEST_FMT_ARGS(SLAVE_SEND_ENTRY, "%s")
@@ -24,9 +26,20 @@
 #define SLAVE_SEND_ENTRY_RESP_SUCCESS GENEATATE_SUCCESS(SLAVE_SEND_ENTRY)
 
 // entries
+#define SLAVE_SEND_ENTRIES_REQ_1E GENERATE_REQUEST_FMT_ARGS(SLAVE_SEND_ENTRIES, "'%s'")
 #define SLAVE_SEND_ENTRIES_RESP_FAIL_1E GENEATATE_FAIL_FMT(SLAVE_SEND_ENTRIES, "%s")
 #define SLAVE_SEND_ENTRIES_RESP_SUCCESS GENEATATE_SUCCESS(SLAVE_SEND_ENTRIES)
 
+// entries binary
+#define SLAVE_SEND_ENTRIES_BINARY_REQ_1E GENERATE_REQUEST_FMT_ARGS(SLAVE_SEND_ENTRIES_BINARY, "%s")
+#define SLAVE_SEND_ENTRIES_BINARY_RESP_FAIL_1E GENEATATE_FAIL_FMT(SLAVE_SEND_ENTRIES_BINARY, "%s")
+#define SLAVE_SEND_ENTRIES_BINARY_RESP_SUCCESS GENEATATE_SUCCESS(SLAVE_SEND_ENTRIES_BINARY)
+
+// stats
+#define SLAVE_SEND_STATS_REQ_1E GENERATE_REQUEST_FMT_ARGS(SLAVE_SEND_STATS, "'%s'")
+#define SLAVE_SEND_STATS_RESP_FAIL_1E GENEATATE_FAIL_FMT(SLAVE_SEND_STATS, "%s")
+#define SLAVE_SEND_STATS_RESP_SUCCESS GENEATATE_SUCCESS(SLAVE_SEND_STATS)
+
 namespace sniffer {
 namespace daemon_client {
 
@@ -34,10 +47,25 @@ protocol::responce_t ActivateSlaveResponceSuccess(protocol::sequance_id_t id) {
   return common::protocols::three_way_handshake::MakeResponce(id, SLAVE_ACTIVATE_RESP_SUCCESS);
 }
 
+protocol::responce_t ActivateSlaveResponceSuccess(protocol::sequance_id_t id,
+                                                  const std::string& entries_encoding,
+                                                  const std::string& compression) {
+  return common::protocols::three_way_handshake::MakeResponce(id, SLAVE_ACTIVATE_RESP_SUCCESS_2E, entries_encoding,
+                                                              compression);
+}
+
+protocol::request_t ActivateSlaveRequest(protocol::sequance_id_t id, protocol::serializet_t msg) {
+  return common::protocols::three_way_handshake::MakeRequest(id, SLAVE_ACTIVATE_REQ_1E, msg);
+}
+
 protocol::responce_t EntrySlaveResponceSuccess(protocol::sequance_id_t id) {
   return common::protocols::three_way_handshake::MakeResponce(id, SLAVE_SEND_ENTRY_RESP_SUCCESS);
 }
 
+protocol::responce_t EntrySlaveResponceFail(protocol::sequance_id_t id, const std::string& error_text) {
+  return common::protocols::three_way_handshake::MakeResponce(id, SLAVE_SEND_ENTRY_RESP_FAIL_1E, error_text);
+}
+
 protocol::request_t EntrySlaveRequest(protocol::sequance_id_t id, protocol::serializet_t msg) {
   return common::protocols::three_way_handshake::MakeRequest(id, SLAVE_SEND_ENTRY_REQ_1E, msg);
 }
@@ -46,5 +74,34 @@ protocol::responce_t EntriesSlaveResponceSuccess(protocol::sequance_id_t id) {
   return common::protocols::three_way_handshake::MakeResponce(id, SLAVE_SEND_ENTRIES_RESP_SUCCESS);
 }
 
+protocol::responce_t EntriesSlaveResponceFail(protocol::sequance_id_t id, const std::string& error_text) {
+  return common::protocols::three_way_handshake::MakeResponce(id, SLAVE_SEND_ENTRIES_RESP_FAIL_1E, error_text);
+}
+
+protocol::request_t EntriesSlaveRequest(protocol::sequance_id_t id, protocol::serializet_t msg) {
+  return common::protocols::three_way_handshake::MakeRequest(id, SLAVE_SEND_ENTRIES_REQ_1E, msg);
+}
+
+protocol::responce_t EntriesBinarySlaveResponceSuccess(protocol::sequance_id_t id) {
+  return common::protocols::three_way_handshake::MakeResponce(id, SLAVE_SEND_ENTRIES_BINARY_RESP_SUCCESS);
+}
+
+protocol::responce_t EntriesBinarySlaveResponceFail(protocol::sequance_id_t id, const std::string& error_text) {
+  return common::protocols::three_way_handshake::MakeResponce(id, SLAVE_SEND_ENTRIES_BINARY_RESP_FAIL_1E,
+                                                              error_text);
+}
+
+protocol::request_t EntriesBinarySlaveRequest(protocol::sequance_id_t id, protocol::serializet_t msg) {
+  return common::protocols::three_way_handshake::MakeRequest(id, SLAVE_SEND_ENTRIES_BINARY_REQ_1E, msg);
+}
+
+protocol::responce_t StatsSlaveResponceSuccess(protocol::sequance_id_t id) {
+  return common::protocols::three_way_handshake::MakeResponce(id, SLAVE_SEND_STATS_RESP_SUCCESS);
+}
+
+protocol::request_t StatsSlaveRequest(protocol::sequance_id_t id, protocol::serializet_t msg) {
+  return common::protocols::three_way_handshake::MakeRequest(id, SLAVE_SEND_STATS_REQ_1E, msg);
+}
+
 }  // namespace server
 }
@@ -19,16 +19,33 @@
 #define SLAVE_ACTIVATE "activate_request"
 #define SLAVE_SEND_ENTRY "send_entry"
 #define SLAVE_SEND_ENTRIES "send_entries"
+#define SLAVE_SEND_ENTRIES_BINARY "send_entries_binary"
+#define SLAVE_SEND_STATS "send_stats"
 
 namespace sniffer {
 namespace daemon_client {
 
 protocol::responce_t ActivateSlaveResponceSuccess(protocol::sequance_id_t id);
+// accepted entries encoding and frame compression are arguments, slaves fall back to json without them
+protocol::responce_t ActivateSlaveResponceSuccess(protocol::sequance_id_t id,
+                                                  const std::string& entries_encoding,
+                                                  const std::string& compression);
+protocol::request_t ActivateSlaveRequest(protocol::sequance_id_t id, protocol::serializet_t msg);
 
 protocol::responce_t EntrySlaveResponceSuccess(protocol::sequance_id_t id);
+protocol::responce_t EntrySlaveResponceFail(protocol::sequance_id_t id, const std::string& error_text);
 protocol::request_t EntrySlaveRequest(protocol::sequance_id_t id, protocol::serializet_t msg);
 
 protocol::responce_t EntriesSlaveResponceSuccess(protocol::sequance_id_t id);
+protocol::responce_t EntriesSlaveResponceFail(protocol::sequance_id_t id, const std::string& error_text);
+protocol::request_t EntriesSlaveRequest(protocol::sequance_id_t id, protocol::serializet_t msg);
+
+protocol::responce_t EntriesBinarySlaveResponceSuccess(protocol::sequance_id_t id);
+protocol::responce_t EntriesBinarySlaveResponceFail(protocol::sequance_id_t id, const std::string& error_text);
+protocol::request_t EntriesBinarySlaveRequest(protocol::sequance_id_t id, protocol::serializet_t msg);
+
+protocol::responce_t StatsSlaveResponceSuccess(protocol::sequance_id_t id);
+protocol::request_t StatsSlaveRequest(protocol::sequance_id_t id, protocol::serializet_t msg);
 
 }  // namespace server
 }
@@ -17,22 +17,28 @@
 #define ENTRY_MAC_ADDRESS_FIELD "mac_address"
 #define ENTRY_TIMESTAMP_FIELD "timestamp"
 #define ENTRY_SSI_FIELD "ssi"
+#define ENTRY_IFACE_FIELD "iface"
+#define ENTRY_COUNT_FIELD "count"
+#define ENTRY_SSI_MIN_FIELD "ssi_min"
+#define ENTRY_SSI_MAX_FIELD "ssi_max"
 
 namespace sniffer {
 
-EntryInfo::EntryInfo() : mac_address_(), timestamp_(0), ssi_(0) {}
+EntryInfo::EntryInfo() : mac_address_(), timestamp_(0), ssi_(0), count_(1), ssi_min_(0), ssi_max_(0), iface_() {}
 
-EntryInfo::EntryInfo(const std::string& mac, common::time64_t ts, int8_t ssi) : mac_address_(mac), timestamp_(ts), ssi_(ssi) {}
+EntryInfo::EntryInfo(const MacAddress& mac, common::time64_t ts, int8_t ssi)
+    : mac_address_(mac), timestamp_(ts), ssi_(ssi), count_(1), ssi_min_(ssi), ssi_max_(ssi), iface_() {}
 
 bool EntryInfo::Equals(const EntryInfo& ent) const {
-  return mac_address_ == ent.mac_address_ && timestamp_ == ent.timestamp_ && ssi_ == ent.ssi_;
+  return mac_address_ == ent.mac_address_ && timestamp_ == ent.timestamp_ && ssi_ == ent.ssi_ &&
+         count_ == ent.count_ && ssi_min_ == ent.ssi_min_ && ssi_max_ == ent.ssi_max_ && iface_ == ent.iface_;
 }
 
 bool EntryInfo::IsValid() const {
-  return !mac_address_.empty();
+  return !mac_address_.IsZero();
 }
 
-std::string EntryInfo::GetMacAddress() const {
+MacAddress EntryInfo::GetMacAddress() const {
   return mac_address_;
 }
 
@@ -48,12 +54,38 @@ int8_t EntryInfo::GetSSI() const {
   return ssi_;
 }
 
+uint32_t EntryInfo::GetCount() const {
+  return count_;
+}
+
+int8_t EntryInfo::GetMinSSI() const {
+  return ssi_min_;
+}
+
+int8_t EntryInfo::GetMaxSSI() const {
+  return ssi_max_;
+}
+
+void EntryInfo::SetAggregate(uint32_t count, int8_t ssi_min, int8_t ssi_max) {
+  count_ = count;
+  ssi_min_ = ssi_min;
+  ssi_max_ = ssi_max;
+}
+
+std::string EntryInfo::GetIface() const {
+  return iface_;
+}
+
+void EntryInfo::SetIface(const std::string& iface) {
+  iface_ = iface;
+}
+
 common::Error EntryInfo::DoDeSerialize(json_object* serialized) {
-  std::string mac_address;
+  MacAddress mac_address;
   json_object* jmac_address = NULL;
   json_bool jmac_address_exists = json_object_object_get_ex(serialized, ENTRY_MAC_ADDRESS_FIELD, &jmac_address);
-  if (jmac_address_exists) {
-    mac_address = json_object_get_string(jmac_address);
+  if (jmac_address_exists && !MacAddress::FromString(json_object_get_string(jmac_address), &mac_address)) {
+    return common::make_error_inval();
   }
 
   common::time64_t timestamp;
@@ -70,7 +102,42 @@ common::Error EntryInfo::DoDeSerialize(json_object* serialized) {
     ssi = json_object_get_int(jssi);
   }
 
+  std::string iface;
+  json_object* jiface = NULL;
+  json_bool jiface_exists = json_object_object_get_ex(serialized, ENTRY_IFACE_FIELD, &jiface);
+  if (jiface_exists) {
+    iface = json_object_get_string(jiface);
+  }
+
+  // single frame entries carry no aggregate fields
+  uint32_t count = 1;
+  json_object* jcount = NULL;
+  json_bool jcount_exists = json_object_object_get_ex(serialized, ENTRY_COUNT_FIELD, &jcount);
+  if (jcount_exists) {
+    const int64_t jcount_value = json_object_get_int64(jcount);
+    if (jcount_value < 1 || jcount_value > UINT32_MAX) {
+      return common::make_error_inval();
+    }
+    count = jcount_value;
+  }
+
+  int8_t ssi_min = ssi;
+  json_object* jssi_min = NULL;
+  json_bool jssi_min_exists = json_object_object_get_ex(serialized, ENTRY_SSI_MIN_FIELD, &jssi_min);
+  if (jssi_min_exists) {
+    ssi_min = json_object_get_int(jssi_min);
+  }
+
+  int8_t ssi_max = ssi;
+  json_object* jssi_max = NULL;
+  json_bool jssi_max_exists = json_object_object_get_ex(serialized, ENTRY_SSI_MAX_FIELD, &jssi_max);
+  if (jssi_max_exists) {
+    ssi_max = json_object_get_int(jssi_max);
+  }
+
   *this = EntryInfo(mac_address, timestamp, ssi);
+  SetAggregate(count, ssi_min, ssi_max);
+  iface_ = iface;
   return common::Error();
 }
 
@@ -79,10 +146,18 @@ common::Error EntryInfo::SerializeFields(json_object* deserialized) const {
     return common::make_error_inval();
   }
 
-  const char* mac_str = mac_address_.c_str();
-  json_object_object_add(deserialized, ENTRY_MAC_ADDRESS_FIELD, json_object_new_string(mac_str));
+  const std::string mac_str = mac_address_.ToString();
+  json_object_object_add(deserialized, ENTRY_MAC_ADDRESS_FIELD, json_object_new_string(mac_str.c_str()));
   json_object_object_add(deserialized, ENTRY_TIMESTAMP_FIELD, json_object_new_int64(timestamp_));
   json_object_object_add(deserialized, ENTRY_SSI_FIELD, json_object_new_int(ssi_));
+  if (!iface_.empty()) {
+    json_object_object_add(deserialized, ENTRY_IFACE_FIELD, json_object_new_string(iface_.c_str()));
+  }
+  if (count_ != 1) {
+    json_object_object_add(deserialized, ENTRY_COUNT_FIELD, json_object_new_int64(count_));
+    json_object_object_add(deserialized, ENTRY_SSI_MIN_FIELD, json_object_new_int(ssi_min_));
+    json_object_object_add(deserialized, ENTRY_SSI_MAX_FIELD, json_object_new_int(ssi_max_));
+  }
   return common::Error();
 }
 }
@@ -18,6 +18,8 @@
 
 #include <common/types.h>
 
+#include "types.h"
+
 #define UNKNOWN_SSI 0
 
 namespace sniffer {
@@ -25,26 +27,39 @@ namespace sniffer {
 class EntryInfo : public common::serializer::JsonSerializer<EntryInfo> {
  public:
   EntryInfo();
-  explicit EntryInfo(const std::string& mac_address, common::time64_t ts, int8_t ssi = UNKNOWN_SSI);
+  explicit EntryInfo(const MacAddress& mac_address, common::time64_t ts, int8_t ssi = UNKNOWN_SSI);
 
   bool Equals(const EntryInfo& ent) const;
   bool IsValid() const;
 
-  std::string GetMacAddress() const;
+  MacAddress GetMacAddress() const;
 
   common::time64_t GetTimestamp() const;
   void SetTimestamp(common::time64_t ts);
 
-  int8_t GetSSI() const;
+  int8_t GetSSI() const;  // mean of aggregated frames
+
+  // frames merged into this entry, signal range of those with known ssi
+  uint32_t GetCount() const;
+  int8_t GetMinSSI() const;
+  int8_t GetMaxSSI() const;
+  void SetAggregate(uint32_t count, int8_t ssi_min, int8_t ssi_max);
+
+  std::string GetIface() const;  // capture interface, empty when not known
+  void SetIface(const std::string& iface);
 
  protected:
   virtual common::Error DoDeSerialize(json_object* serialized) override;
   virtual common::Error SerializeFields(json_object* deserialized) const override;
 
  private:
-  std::string mac_address_;
+  MacAddress mac_address_;
   common::time64_t timestamp_;
   int8_t ssi_;
+  uint32_t count_;
+  int8_t ssi_min_;
+  int8_t ssi_max_;
+  std::string iface_;
 };
 
 inline bool operator==(const EntryInfo& left, const EntryInfo& right) {
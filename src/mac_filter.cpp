@@ -0,0 +1,205 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "mac_filter.h"
+
+#include <errno.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+
+#include <common/logger.h>
+#include <common/sprintf.h>
+
+namespace sniffer {
+
+namespace {
+const size_t kBloomBitsPerMac = 16;  // ~1.5% false positives with two probes
+const size_t kMaxReportedInvalidLines = 10;
+
+size_t RoundUpPowerOfTwo(size_t value) {
+  size_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+std::mutex g_filter_mutex;
+std::shared_ptr<const MacFilter> g_filter;
+std::atomic<uint64_t> g_filter_generation(0);
+
+thread_local std::shared_ptr<const MacFilter> t_filter;
+thread_local uint64_t t_filter_generation = 0;
+}  // namespace
+
+const uint64_t MacSet::empty_slot;
+
+MacSet::MacSet(const std::vector<MacAddress>& macs, bool bloom)
+    : slots_(), slots_mask_(0), bloom_(), bloom_mask_(0), size_(0) {
+  // load factor at most one half keeps probe chains short
+  const size_t slots_count = RoundUpPowerOfTwo(std::max<size_t>(macs.size() * 2, 16));
+  slots_.assign(slots_count, empty_slot);
+  slots_mask_ = slots_count - 1;
+  if (bloom) {
+    const size_t bits = RoundUpPowerOfTwo(std::max<size_t>(macs.size() * kBloomBitsPerMac, 64));
+    bloom_.assign(bits / 64, 0);
+    bloom_mask_ = bits - 1;
+  }
+
+  for (size_t i = 0; i < macs.size(); ++i) {
+    Insert(macs[i].GetValue());
+  }
+}
+
+void MacSet::Insert(uint64_t value) {
+  const uint64_t hash = Hash(value);
+  size_t slot = hash & slots_mask_;
+  while (slots_[slot] != empty_slot) {
+    if (slots_[slot] == value) {
+      return;
+    }
+    slot = (slot + 1) & slots_mask_;
+  }
+  slots_[slot] = value;
+  size_++;
+
+  if (!bloom_.empty()) {
+    const uint64_t first = (hash >> 32) & bloom_mask_;
+    const uint64_t second = ((hash * UINT64_C(0xC2B2AE3D27D4EB4F)) >> 32) & bloom_mask_;
+    bloom_[first >> 6] |= UINT64_C(1) << (first & 63);
+    bloom_[second >> 6] |= UINT64_C(1) << (second & 63);
+  }
+}
+
+MacFilter::MacFilter(Mode mode, const std::vector<MacAddress>& macs, bool bloom) : mode_(mode), set_(macs, bloom) {}
+
+common::Error MacFilter::LoadFromFile(const std::string& path,
+                                      Mode mode,
+                                      bool bloom,
+                                      std::shared_ptr<const MacFilter>* filter) {
+  if (path.empty() || !filter) {
+    return common::make_error_inval();
+  }
+
+  std::ifstream file(path.c_str());
+  if (!file.is_open()) {
+    return common::make_error(
+        common::MemSPrintf("error opening mac filter file: %s, errno: %d", path.c_str(), errno));
+  }
+
+  std::vector<MacAddress> macs;
+  std::string line;
+  size_t line_number = 0;
+  size_t invalid = 0;
+  while (std::getline(file, line)) {
+    line_number++;
+    const size_t comment = line.find('#');
+    if (comment != std::string::npos) {
+      line.erase(comment);
+    }
+    const size_t begin = line.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+      continue;
+    }
+    const size_t end = line.find_last_not_of(" \t\r");
+
+    MacAddress mac;
+    if (!MacAddress::FromString(line.substr(begin, end - begin + 1), &mac)) {
+      if (invalid++ < kMaxReportedInvalidLines) {
+        WARNING_LOG() << "Invalid mac address in filter file: " << path << ", line: " << line_number;
+      }
+      continue;
+    }
+    macs.push_back(mac);
+  }
+
+  if (file.bad()) {
+    return common::make_error(common::MemSPrintf("error reading mac filter file: %s", path.c_str()));
+  }
+  if (invalid > kMaxReportedInvalidLines) {
+    WARNING_LOG() << "Mac filter file: " << path << ", invalid lines skipped: " << invalid;
+  }
+
+  *filter = std::make_shared<const MacFilter>(mode, macs, bloom);
+  return common::Error();
+}
+
+void SetMacFilter(const std::shared_ptr<const MacFilter>& filter) {
+  std::lock_guard<std::mutex> lock(g_filter_mutex);
+  g_filter = filter;
+  g_filter_generation.fetch_add(1, std::memory_order_release);
+}
+
+const MacFilter* GetMacFilter() {
+  // readers touch shared state only once per swap, previous filter is freed by last thread moving off it
+  if (g_filter_generation.load(std::memory_order_acquire) != t_filter_generation) {
+    std::lock_guard<std::mutex> lock(g_filter_mutex);
+    t_filter = g_filter;
+    t_filter_generation = g_filter_generation.load(std::memory_order_relaxed);
+  }
+  return t_filter.get();
+}
+
+MacFilterReloader::MacFilterReloader(const std::string& path, MacFilter::Mode mode, bool bloom)
+    : path_(path), mode_(mode), bloom_(bloom), mtime_() {}
+
+common::Error MacFilterReloader::Load() {
+  struct stat st;
+  if (stat(path_.c_str(), &st) != 0) {
+    return common::make_error(
+        common::MemSPrintf("error opening mac filter file: %s, errno: %d", path_.c_str(), errno));
+  }
+
+  std::shared_ptr<const MacFilter> filter;
+  common::Error err = MacFilter::LoadFromFile(path_, mode_, bloom_, &filter);
+  if (err) {
+    return err;
+  }
+
+  mtime_ = st.st_mtim;
+  SetMacFilter(filter);
+  INFO_LOG() << "Mac " << (mode_ == MacFilter::ALLOW_LIST ? "allow" : "deny") << " list loaded: " << path_
+             << ", addresses: " << filter->GetSize() << ", bloom: " << bloom_;
+  return common::Error();
+}
+
+common::Error MacFilterReloader::ReloadIfChanged(bool* reloaded) {
+  if (!reloaded) {
+    return common::make_error_inval();
+  }
+
+  *reloaded = false;
+  struct stat st;
+  if (stat(path_.c_str(), &st) != 0) {
+    // file is being replaced, keep serving current filter
+    return common::Error();
+  }
+  if (st.st_mtim.tv_sec == mtime_.tv_sec && st.st_mtim.tv_nsec == mtime_.tv_nsec) {
+    return common::Error();
+  }
+
+  common::Error err = Load();
+  if (err) {
+    return err;
+  }
+  *reloaded = true;
+  return common::Error();
+}
+
+}  // namespace sniffer
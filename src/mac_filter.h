@@ -0,0 +1,124 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <time.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <common/error.h>
+#include <common/macros.h>
+
+#include "types.h"
+
+namespace sniffer {
+
+// open addressing set of addresses with optional bloom prefilter, immutable after construction
+class MacSet {
+ public:
+  explicit MacSet(const std::vector<MacAddress>& macs, bool bloom = false);
+
+  bool Contains(const MacAddress& mac) const {
+    const uint64_t hash = Hash(mac.GetValue());
+    if (!bloom_.empty()) {
+      // probes taken from high bits, independent from slot index
+      const uint64_t first = (hash >> 32) & bloom_mask_;
+      const uint64_t second = ((hash * UINT64_C(0xC2B2AE3D27D4EB4F)) >> 32) & bloom_mask_;
+      if (!(bloom_[first >> 6] & (UINT64_C(1) << (first & 63))) ||
+          !(bloom_[second >> 6] & (UINT64_C(1) << (second & 63)))) {
+        return false;
+      }
+    }
+    for (size_t slot = hash & slots_mask_;; slot = (slot + 1) & slots_mask_) {
+      const uint64_t key = slots_[slot];
+      if (key == mac.GetValue()) {
+        return true;
+      }
+      if (key == empty_slot) {
+        return false;
+      }
+    }
+  }
+
+  size_t GetSize() const { return size_; }
+  bool HasBloom() const { return !bloom_.empty(); }
+
+ private:
+  static const uint64_t empty_slot = ~UINT64_C(0);  // never a 48 bit address
+
+  static uint64_t Hash(uint64_t value) {
+    value *= UINT64_C(0x9E3779B97F4A7C15);
+    return value ^ (value >> 29);
+  }
+
+  void Insert(uint64_t value);
+
+  std::vector<uint64_t> slots_;
+  size_t slots_mask_;
+  std::vector<uint64_t> bloom_;
+  uint64_t bloom_mask_;
+  size_t size_;
+};
+
+class MacFilter {
+ public:
+  enum Mode { DENY_LIST = 0, ALLOW_LIST };
+
+  MacFilter(Mode mode, const std::vector<MacAddress>& macs, bool bloom);
+
+  // file holds one address per line, '#' starts comment
+  static common::Error LoadFromFile(const std::string& path,
+                                    Mode mode,
+                                    bool bloom,
+                                    std::shared_ptr<const MacFilter>* filter) WARN_UNUSED_RESULT;
+
+  bool IsAllowed(const MacAddress& mac) const { return set_.Contains(mac) == (mode_ == ALLOW_LIST); }
+
+  Mode GetMode() const { return mode_; }
+  size_t GetSize() const { return set_.GetSize(); }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(MacFilter);
+
+  const Mode mode_;
+  const MacSet set_;
+};
+
+// filter applied by packet parsers, replaced without stopping capture, NULL - everything allowed
+void SetMacFilter(const std::shared_ptr<const MacFilter>& filter);
+// snapshot of calling thread, valid until its next call
+const MacFilter* GetMacFilter();
+
+// reloads filter file when modification time changes, loop thread only
+class MacFilterReloader {
+ public:
+  MacFilterReloader(const std::string& path, MacFilter::Mode mode, bool bloom);
+
+  common::Error Load() WARN_UNUSED_RESULT;  // first load, installs filter
+  common::Error ReloadIfChanged(bool* reloaded) WARN_UNUSED_RESULT;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(MacFilterReloader);
+
+  const std::string path_;
+  const MacFilter::Mode mode_;
+  const bool bloom_;
+  struct timespec mtime_;
+};
+
+}  // namespace sniffer
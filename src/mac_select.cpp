@@ -0,0 +1,163 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "mac_select.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MAC_SELECT_X86
+#endif
+
+namespace sniffer {
+
+namespace {
+MacSelectRules g_rules;
+
+inline size_t select_macs_tail(const uint64_t* macs,
+                               size_t begin,
+                               size_t count,
+                               const MacSelectRules& rules,
+                               uint16_t* selected,
+                               size_t selected_count) {
+  for (size_t i = begin; i < count; ++i) {
+    const uint64_t mac = macs[i];
+    bool drop = mac & rules.reject_bits;
+    for (size_t j = 0; j < rules.deny_count; ++j) {
+      drop |= mac == rules.deny[j];
+    }
+    if (!drop) {
+      selected[selected_count++] = i;
+    }
+  }
+  return selected_count;
+}
+
+// lanes of keep mask, lowest bit - first mac
+inline size_t emit_selected(unsigned mask, size_t base, uint16_t* selected, size_t selected_count) {
+  while (mask) {
+    selected[selected_count++] = base + __builtin_ctz(mask);
+    mask &= mask - 1;
+  }
+  return selected_count;
+}
+
+size_t select_macs_scalar(const uint64_t* macs, size_t count, const MacSelectRules& rules, uint16_t* selected) {
+  return select_macs_tail(macs, 0, count, rules, selected, 0);
+}
+
+#ifdef MAC_SELECT_X86
+__attribute__((target("sse4.1"))) size_t select_macs_sse(const uint64_t* macs,
+                                                         size_t count,
+                                                         const MacSelectRules& rules,
+                                                         uint16_t* selected) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i reject = _mm_set1_epi64x(rules.reject_bits);
+  __m128i deny[MacSelectRules::max_deny];
+  for (size_t j = 0; j < rules.deny_count; ++j) {
+    deny[j] = _mm_set1_epi64x(rules.deny[j]);
+  }
+
+  size_t selected_count = 0;
+  size_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(macs + i));
+    __m128i keep = _mm_cmpeq_epi64(_mm_and_si128(value, reject), zero);
+    for (size_t j = 0; j < rules.deny_count; ++j) {
+      keep = _mm_andnot_si128(_mm_cmpeq_epi64(value, deny[j]), keep);
+    }
+    selected_count = emit_selected(_mm_movemask_pd(_mm_castsi128_pd(keep)), i, selected, selected_count);
+  }
+  return select_macs_tail(macs, i, count, rules, selected, selected_count);
+}
+
+__attribute__((target("avx2"))) size_t select_macs_avx2(const uint64_t* macs,
+                                                        size_t count,
+                                                        const MacSelectRules& rules,
+                                                        uint16_t* selected) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i reject = _mm256_set1_epi64x(rules.reject_bits);
+  __m256i deny[MacSelectRules::max_deny];
+  for (size_t j = 0; j < rules.deny_count; ++j) {
+    deny[j] = _mm256_set1_epi64x(rules.deny[j]);
+  }
+
+  size_t selected_count = 0;
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(macs + i));
+    __m256i keep = _mm256_cmpeq_epi64(_mm256_and_si256(value, reject), zero);
+    for (size_t j = 0; j < rules.deny_count; ++j) {
+      keep = _mm256_andnot_si256(_mm256_cmpeq_epi64(value, deny[j]), keep);
+    }
+    selected_count = emit_selected(_mm256_movemask_pd(_mm256_castsi256_pd(keep)), i, selected, selected_count);
+  }
+  return select_macs_tail(macs, i, count, rules, selected, selected_count);
+}
+#endif
+
+detail::MacSelectKernel DetectSelectKernel() {
+#ifdef MAC_SELECT_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return {"avx2", select_macs_avx2};
+  }
+  if (__builtin_cpu_supports("sse4.1")) {
+    return {"sse4.1", select_macs_sse};
+  }
+#endif
+  return {"scalar", select_macs_scalar};
+}
+
+const detail::MacSelectKernel& GetSelectKernel() {
+  static const detail::MacSelectKernel kernel = DetectSelectKernel();
+  return kernel;
+}
+}  // namespace
+
+MacSelectRules::MacSelectRules() : reject_bits(MAC_GROUP_BIT), deny(), deny_count(0) {}
+
+void SetMacSelectRules(const MacSelectRules& rules) {
+  g_rules = rules;
+  g_rules.reject_bits |= MAC_GROUP_BIT;
+}
+
+const MacSelectRules& GetMacSelectRules() {
+  return g_rules;
+}
+
+size_t SelectMacs(const uint64_t* macs, size_t count, const MacSelectRules& rules, uint16_t* selected) {
+  return GetSelectKernel().select(macs, count, rules, selected);
+}
+
+const char* GetMacSelectKernelName() {
+  return GetSelectKernel().name;
+}
+
+namespace detail {
+std::vector<MacSelectKernel> GetSupportedMacSelectKernels() {
+  std::vector<MacSelectKernel> kernels = {{"scalar", select_macs_scalar}};
+#ifdef MAC_SELECT_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse4.1")) {
+    kernels.push_back({"sse4.1", select_macs_sse});
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    kernels.push_back({"avx2", select_macs_avx2});
+  }
+#endif
+  return kernels;
+}
+}  // namespace detail
+}  // namespace sniffer
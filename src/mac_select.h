@@ -0,0 +1,60 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "types.h"
+
+#define MAC_GROUP_BIT (UINT64_C(0x01) << 40)
+#define MAC_LOCAL_BIT (UINT64_C(0x02) << 40)
+
+namespace sniffer {
+
+// checks applied to every parsed batch before entries are built
+struct MacSelectRules {
+  enum { max_deny = 16 };
+
+  MacSelectRules();
+
+  uint64_t reject_bits;  // address with any of these bits set is dropped, MAC_GROUP_BIT at least
+  uint64_t deny[max_deny];
+  size_t deny_count;
+};
+
+// process wide rules, set before capture starts
+void SetMacSelectRules(const MacSelectRules& rules);
+const MacSelectRules& GetMacSelectRules();
+
+// writes indexes of macs passing rules into selected (count entries), returns number written,
+// vectorised with SSE4.1 or AVX2 when cpu supports it
+size_t SelectMacs(const uint64_t* macs, size_t count, const MacSelectRules& rules, uint16_t* selected);
+
+const char* GetMacSelectKernelName();
+
+namespace detail {
+struct MacSelectKernel {
+  const char* name;
+  size_t (*select)(const uint64_t* macs, size_t count, const MacSelectRules& rules, uint16_t* selected);
+};
+
+// kernels this cpu can run, scalar first, for comparing them against each other
+std::vector<MacSelectKernel> GetSupportedMacSelectKernels();
+}  // namespace detail
+}  // namespace sniffer
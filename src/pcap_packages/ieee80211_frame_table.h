@@ -0,0 +1,122 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pcap_packages/radiotap_header.h"
+
+// address fields offsets from frame start
+#define IEEE80211_ADDR2_OFFSET 10
+#define IEEE80211_ADDR4_OFFSET 24
+
+#define IEEE80211_FRAME_CLASSES 64  // type (2 bits) x subtype (4 bits)
+
+namespace sniffer {
+
+enum IEEE80211_FRAME_ACTION { IEEE80211_FRAME_KEEP = 0, IEEE80211_FRAME_SKIP, IEEE80211_FRAME_INVALID };
+
+// what parser does with one frame kind, per address layout indexed by
+// ToDS | FromDS << 1, the two low bits of second frame control octet
+struct ieee80211_frame_class {
+  uint8_t action;            // IEEE80211_FRAME_ACTION
+  uint8_t source_offset[4];  // station the frame is attributed to
+  uint8_t min_length[4];     // header bytes needed to read it
+};
+
+namespace detail {
+constexpr uint8_t ieee80211_frame_action(unsigned type, unsigned subtype) {
+  return type == TYPE_MNGMT
+             ? (subtype == 7 || subtype == 15 ? IEEE80211_FRAME_INVALID : IEEE80211_FRAME_KEEP)
+             : type == TYPE_CNTRL
+                   // reserved, extension and frames carrying only receiver address
+                   ? (subtype < 2 ? IEEE80211_FRAME_INVALID
+                                  : subtype == 6 || subtype == SUBTYPE_CNTRL_ControlWrapper ||
+                                            subtype == SUBTYPE_CNTRL_CTS || subtype == SUBTYPE_CNTRL_ACK
+                                        ? IEEE80211_FRAME_SKIP
+                                        : IEEE80211_FRAME_KEEP)
+                   : type == TYPE_DATA ? (subtype == 13 ? IEEE80211_FRAME_INVALID : IEEE80211_FRAME_KEEP)
+                                       : IEEE80211_FRAME_INVALID;
+}
+
+// four address (WDS, mesh) data frames are relayed, original sender is addr4,
+// in other layouts addr2 is the station on air: client, access point or control frame TA
+constexpr uint8_t ieee80211_source_offset(unsigned type, unsigned ds) {
+  return type == TYPE_DATA && ds == 3 ? IEEE80211_ADDR4_OFFSET : IEEE80211_ADDR2_OFFSET;
+}
+
+constexpr uint8_t ieee80211_min_length(unsigned type, unsigned ds) {
+  return type == TYPE_CNTRL ? IEEE80211_ADDR2_OFFSET + ETH_ALEN
+                            : type == TYPE_DATA && ds == 3 ? IEEE80211_ADDR4_OFFSET + ETH_ALEN
+                                                           : sizeof(ieee80211header);
+}
+
+constexpr ieee80211_frame_class ieee80211_make_frame_class(unsigned index) {
+  return ieee80211_frame_class{
+      ieee80211_frame_action(index & 3, index >> 2),
+      {ieee80211_source_offset(index & 3, 0), ieee80211_source_offset(index & 3, 1),
+       ieee80211_source_offset(index & 3, 2), ieee80211_source_offset(index & 3, 3)},
+      {ieee80211_min_length(index & 3, 0), ieee80211_min_length(index & 3, 1), ieee80211_min_length(index & 3, 2),
+       ieee80211_min_length(index & 3, 3)}};
+}
+}  // namespace detail
+
+#define IEEE80211_FRAME_CLASS_4(i)                                                  \
+  detail::ieee80211_make_frame_class(i), detail::ieee80211_make_frame_class(i + 1), \
+      detail::ieee80211_make_frame_class(i + 2), detail::ieee80211_make_frame_class(i + 3)
+#define IEEE80211_FRAME_CLASS_16(i)                            \
+  IEEE80211_FRAME_CLASS_4(i), IEEE80211_FRAME_CLASS_4(i + 4), \
+      IEEE80211_FRAME_CLASS_4(i + 8), IEEE80211_FRAME_CLASS_4(i + 12)
+
+// indexed by first frame control octet without protocol version bits: type | subtype << 2
+constexpr ieee80211_frame_class kIeee80211FrameClasses[IEEE80211_FRAME_CLASSES] = {
+    IEEE80211_FRAME_CLASS_16(0), IEEE80211_FRAME_CLASS_16(16), IEEE80211_FRAME_CLASS_16(32),
+    IEEE80211_FRAME_CLASS_16(48)};
+
+#undef IEEE80211_FRAME_CLASS_16
+#undef IEEE80211_FRAME_CLASS_4
+
+namespace detail {
+// walks every class and address layout, index is class * 4 + ds
+constexpr size_t ieee80211_max_min_length(unsigned index = 0, size_t longest = 0) {
+  return index == IEEE80211_FRAME_CLASSES * 4
+             ? longest
+             : ieee80211_max_min_length(index + 1,
+                                        kIeee80211FrameClasses[index >> 2].min_length[index & 3] > longest
+                                            ? kIeee80211FrameClasses[index >> 2].min_length[index & 3]
+                                            : longest);
+}
+}  // namespace detail
+
+// longest frame header any class needs, capture snaplen must cover it
+constexpr size_t kIeee80211MaxHeaderLength = detail::ieee80211_max_min_length();
+
+static_assert(kIeee80211FrameClasses[TYPE_CNTRL | SUBTYPE_CNTRL_ACK << 2].action == IEEE80211_FRAME_SKIP,
+              "ack carries receiver only");
+static_assert(kIeee80211FrameClasses[TYPE_DATA | SUBTYPE_DATA_QOS_DATA << 2].source_offset[3] ==
+                  IEEE80211_ADDR4_OFFSET,
+              "four address data frame is attributed to addr4");
+static_assert(kIeee80211MaxHeaderLength == IEEE80211_ADDR4_OFFSET + ETH_ALEN, "four address header is the longest");
+
+inline const ieee80211_frame_class& ieee80211_classify(const uint8_t* frame) {
+  return kIeee80211FrameClasses[frame[0] >> 2];
+}
+
+inline unsigned ieee80211_ds_bits(const uint8_t* frame) {
+  return frame[1] & 3;
+}
+}  // namespace sniffer
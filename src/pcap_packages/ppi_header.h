@@ -0,0 +1,49 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stdint.h>
+
+#include "pcap_packages/radiotap_header.h"
+
+// Per-Packet Information header, DLT_PPI, little endian
+
+#define PPI_VERSION 0
+#define PPI_FIELD_80211_COMMON 2
+
+struct PACKED_ATTRIBUTE ppi_header {
+  uint8_t pph_version;
+  uint8_t pph_flags;
+  uint16_t pph_len;  // whole header, frame of pph_dlt follows
+  uint32_t pph_dlt;
+};
+
+struct PACKED_ATTRIBUTE ppi_field_header {
+  uint16_t pfh_type;
+  uint16_t pfh_datalen;
+};
+
+struct PACKED_ATTRIBUTE ppi_80211_common {
+  uint64_t tsf_timer;
+  uint16_t flags;
+  uint16_t rate;
+  uint16_t channel_freq;
+  uint16_t channel_flags;
+  uint8_t fhss_hopset;
+  uint8_t fhss_pattern;
+  int8_t dbm_antsignal;
+  int8_t dbm_antnoise;
+};
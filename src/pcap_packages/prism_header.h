@@ -0,0 +1,45 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stdint.h>
+
+#include "pcap_packages/radiotap_header.h"
+
+// wlan-ng AVS prism2 monitor header, DLT_PRISM_HEADER, host byte order
+
+struct PACKED_ATTRIBUTE prism_item {
+  uint32_t did;
+  uint16_t status;  // 0 - supplied, 1 - not supplied
+  uint16_t len;
+  uint32_t data;
+};
+
+struct PACKED_ATTRIBUTE prism_header {
+  uint32_t msgcode;
+  uint32_t msglen;  // whole header, 802.11 frame follows
+  char devname[16];
+  struct prism_item hosttime;
+  struct prism_item mactime;
+  struct prism_item channel;
+  struct prism_item rssi;
+  struct prism_item sq;
+  struct prism_item signal;  // dBm
+  struct prism_item noise;
+  struct prism_item rate;
+  struct prism_item istx;
+  struct prism_item frmlen;
+};
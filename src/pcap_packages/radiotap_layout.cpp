@@ -0,0 +1,142 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "pcap_packages/radiotap_layout.h"
+
+#include <endian.h>
+#include <string.h>
+
+namespace sniffer {
+
+namespace {
+
+struct RadiotapFieldSpec {
+  uint8_t align;
+  uint8_t size;
+};
+
+// https://www.radiotap.org/fields/defined, indexed by ieee80211_radiotap_presence
+const RadiotapFieldSpec kRadiotapFields[IEEE80211_RADIOTAP_KNOWN_FIELDS] = {
+    {8, 8},   // TSFT
+    {1, 1},   // FLAGS
+    {1, 1},   // RATE
+    {2, 4},   // CHANNEL
+    {1, 2},   // FHSS
+    {1, 1},   // DBM_ANTSIGNAL
+    {1, 1},   // DBM_ANTNOISE
+    {2, 2},   // LOCK_QUALITY
+    {2, 2},   // TX_ATTENUATION
+    {2, 2},   // DB_TX_ATTENUATION
+    {1, 1},   // DBM_TX_POWER
+    {1, 1},   // ANTENNA
+    {1, 1},   // DB_ANTSIGNAL
+    {1, 1},   // DB_ANTNOISE
+    {2, 2},   // RX_FLAGS
+    {2, 2},   // TX_FLAGS
+    {1, 1},   // RTS_RETRIES
+    {1, 1},   // DATA_RETRIES
+    {4, 8},   // XCHANNEL
+    {1, 3},   // MCS
+    {4, 8},   // AMPDU_STATUS
+    {2, 12},  // VHT
+    {8, 12},  // TIMESTAMP
+    {2, 12},  // HE
+    {2, 12},  // HE_MU
+    {2, 6},   // HE_MU_OTHER_USER
+    {1, 1},   // ZERO_LEN_PSDU
+    {2, 4}    // L_SIG
+};
+
+const size_t kLayoutCacheSize = 256;  // power of 2
+
+thread_local RadiotapLayout layout_cache[kLayoutCacheSize];
+
+uint32_t read_le32(const uint8_t* data) {
+  uint32_t value;
+  memcpy(&value, data, sizeof(value));
+  return le32toh(value);
+}
+
+void build_layout(uint32_t present, size_t extended_words, RadiotapLayout* layout) {
+  // TLV and namespace bits are above known ones, their data follows known fields
+  size_t offset = sizeof(struct ieee80211_radiotap_header) + extended_words * sizeof(uint32_t);
+  for (size_t i = 0; i < IEEE80211_RADIOTAP_KNOWN_FIELDS; ++i) {
+    if (!(present & (1u << i))) {
+      layout->offsets[i] = -1;
+      continue;
+    }
+
+    const RadiotapFieldSpec& spec = kRadiotapFields[i];
+    offset = (offset + spec.align - 1) & ~static_cast<size_t>(spec.align - 1);
+    layout->offsets[i] = offset;
+    offset += spec.size;
+  }
+}
+}  // namespace
+
+const RadiotapLayout* GetRadiotapLayout(const uint8_t* frame, size_t caplen, size_t* header_len) {
+  if (!frame || !header_len || caplen < sizeof(struct ieee80211_radiotap_header)) {
+    return NULL;
+  }
+
+  const struct ieee80211_radiotap_header* header = reinterpret_cast<const struct ieee80211_radiotap_header*>(frame);
+  const size_t len = le16toh(header->it_len);
+  if (header->it_version != PKTHDR_RADIOTAP_VERSION || len < sizeof(struct ieee80211_radiotap_header) ||
+      len > caplen) {
+    return NULL;
+  }
+
+  const uint32_t present = read_le32(frame + offsetof(struct ieee80211_radiotap_header, it_present));
+  size_t extended_words = 0;
+  size_t pos = sizeof(struct ieee80211_radiotap_header);
+  for (uint32_t word = present; word & (1u << IEEE80211_RADIOTAP_EXT); ++extended_words) {
+    if (extended_words == IEEE80211_RADIOTAP_MAX_PRESENT_WORDS || pos + sizeof(uint32_t) > len) {
+      return NULL;
+    }
+    word = read_le32(frame + pos);
+    pos += sizeof(uint32_t);
+  }
+
+  // offsets of default namespace fields depend only on first word and where data starts
+  const uint64_t key = present | static_cast<uint64_t>(extended_words) << 32;
+  const size_t slot = (key * 0x9E3779B97F4A7C15ULL) >> 56 & (kLayoutCacheSize - 1);
+  RadiotapLayout* layout = &layout_cache[slot];
+  if (!layout->cached || layout->key != key) {
+    build_layout(present, extended_words, layout);
+    layout->key = key;
+    layout->cached = true;
+  }
+
+  *header_len = len;
+  return layout;
+}
+
+bool GetRadiotapField(const RadiotapLayout* layout,
+                      size_t header_len,
+                      enum ieee80211_radiotap_presence field,
+                      size_t* offset) {
+  if (!layout || !offset || field < 0 || field >= IEEE80211_RADIOTAP_KNOWN_FIELDS) {
+    return false;
+  }
+
+  const int16_t field_offset = layout->offsets[field];
+  if (field_offset < 0 || static_cast<size_t>(field_offset) + kRadiotapFields[field].size > header_len) {
+    return false;
+  }
+
+  *offset = field_offset;
+  return true;
+}
+}
@@ -0,0 +1,45 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pcap_packages/radiotap.h"
+
+#define IEEE80211_RADIOTAP_KNOWN_FIELDS 28  // TSFT .. L_SIG of default namespace
+#define IEEE80211_RADIOTAP_MAX_PRESENT_WORDS 16
+
+namespace sniffer {
+
+// offsets of default namespace fields from radiotap header start, fields follow all presence words
+// and are aligned to their natural size relative to header start
+struct RadiotapLayout {
+  uint64_t key;  // first presence word | count of extended words << 32
+  bool cached;
+  int16_t offsets[IEEE80211_RADIOTAP_KNOWN_FIELDS];  // -1 if not present
+};
+
+// validates header of radiotap frame, layout is computed once per distinct presence bitmap
+// and kept in thread local cache until evicted by another bitmap, NULL if malformed or truncated
+const RadiotapLayout* GetRadiotapLayout(const uint8_t* frame, size_t caplen, size_t* header_len);
+
+// locates field inside header of header_len bytes, false if absent
+bool GetRadiotapField(const RadiotapLayout* layout,
+                      size_t header_len,
+                      enum ieee80211_radiotap_presence field,
+                      size_t* offset);
+}
@@ -0,0 +1,38 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stdint.h>
+
+#include "pcap_packages/radiotap_header.h"
+
+// Linux cooked capture v2, DLT_LINUX_SLL2, network byte order
+
+#ifndef DLT_LINUX_SLL2
+#define DLT_LINUX_SLL2 276
+#endif
+
+#define SLL2_ADDRLEN 8
+
+struct PACKED_ATTRIBUTE sll2_header {
+  uint16_t sll2_protocol;  // ethertype
+  uint16_t sll2_reserved;
+  uint32_t sll2_if_index;
+  uint16_t sll2_hatype;  // ARPHRD_ type
+  uint8_t sll2_pkttype;
+  uint8_t sll2_halen;
+  uint8_t sll2_addr[SLL2_ADDRLEN];  // link-layer source address
+};
@@ -15,6 +15,9 @@
 #include "process_wrapper.h"
 
 #include <stdlib.h>
+#include <string.h>
+
+#include <iostream>
 
 #include <common/sys_byteorder.h>
 #include <common/convert2string.h>
@@ -27,8 +30,11 @@ extern "C" {
 #include "daemon_client/daemon_server.h"
 #include "daemon_client/common_commands.h"
 #include "daemon_client/daemon_commands.h"
+#include "daemon_client/slave_master_commands.h"
 
 #include "commands_info/activate_info.h"
+#include "commands_info/entries_binary.h"
+#include "commands_info/license_info.h"
 #include "commands_info/stop_service_info.h"
 
 namespace sniffer {
@@ -77,6 +83,49 @@ int ProcessWrapper::SendStopDaemonRequest(const std::string& license_key,
   return EXIT_SUCCESS;
 }
 
+int ProcessWrapper::SendGetStatsRequest(const std::string& license_key,
+                                        const common::net::HostAndPort& service_host) {
+  commands_info::LicenseInfo stats_req(license_key);
+  std::string stats_str;
+  common::Error serialize_error = stats_req.SerializeToString(&stats_str);
+  if (serialize_error) {
+    return EXIT_FAILURE;
+  }
+
+  protocol::request_t req = daemon_client::GetStatsRequest("0", stats_str);
+  common::net::socket_info client_info;
+  common::ErrnoError err = common::net::connect(service_host, common::net::ST_SOCK_STREAM, 0, &client_info);
+  if (err) {
+    return EXIT_FAILURE;
+  }
+
+  daemon_client::DaemonClient* connection = new daemon_client::DaemonClient(nullptr, client_info);
+  daemon_client::ProtocoledDaemonClient* pconnection = static_cast<daemon_client::ProtocoledDaemonClient*>(connection);
+  int res = EXIT_FAILURE;
+  std::string responce;
+  common::Error write_err = pconnection->WriteRequest(req);
+  if (!write_err && !pconnection->ReadCommand(&responce)) {
+    common::protocols::three_way_handshake::cmd_id_t seq;
+    protocol::sequance_id_t id;
+    std::string cmd_str;
+    common::Error parse_err = common::protocols::three_way_handshake::ParseCommand(responce, &seq, &id, &cmd_str);
+    int argc = 0;
+    sds* argv = parse_err ? NULL : sdssplitargslong(cmd_str.c_str(), &argc);
+    if (argv) {
+      // ok get_stats '{...}' or fail get_stats 'error'
+      if (argc > 2) {
+        std::cout << argv[2] << std::endl;
+        res = strcmp(argv[0], "ok") == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+      }
+      sdsfreesplitres(argv, argc);
+    }
+  }
+
+  connection->Close();
+  delete connection;
+  return res;
+}
+
 void ProcessWrapper::PreLooped(common::libev::IoLoop* server) {
   ping_client_id_timer_ = server->CreateTimer(ping_timeout_clients_seconds, true);
 }
@@ -174,6 +223,10 @@ common::Error ProcessWrapper::DaemonDataReceived(daemon_client::DaemonClient* dc
     return err;  // i don't want handle spam, comand must be foramated according protocol
   }
 
+  if (input_command.empty()) {  // dictionary frame, consumed by codec
+    return common::Error();
+  }
+
   common::protocols::three_way_handshake::cmd_id_t seq;
   protocol::sequance_id_t id;
   std::string cmd_str;
@@ -226,6 +279,8 @@ common::Error ProcessWrapper::HandleRequestServiceCommand(daemon_client::DaemonC
     return HandleRequestClientStopService(dclient, id, argc, argv);
   } else if (IS_EQUAL_COMMAND(command, CLIENT_ACTIVATE)) {
     return HandleRequestClientActivate(dclient, id, argc, argv);
+  } else if (IS_EQUAL_COMMAND(command, CLIENT_GET_STATS)) {
+    return HandleRequestClientGetStats(dclient, id, argc, argv);
   } else {
     WARNING_LOG() << "Received unknown command: " << command;
   }
@@ -278,6 +333,53 @@ common::Error ProcessWrapper::HandleRequestClientStopService(daemon_client::Daem
   return common::make_error_inval();
 }
 
+common::Error ProcessWrapper::HandleRequestClientGetStats(daemon_client::DaemonClient* dclient,
+                                                          protocol::sequance_id_t id,
+                                                          int argc,
+                                                          char* argv[]) {
+  CHECK(loop_->IsLoopThread());
+  if (argc > 1) {
+    json_object* jstats = json_tokener_parse(argv[1]);
+    if (!jstats) {
+      return common::make_error_inval();
+    }
+
+    commands_info::LicenseInfo license_info;
+    common::Error err = license_info.DeSerialize(jstats);
+    json_object_put(jstats);
+    if (err) {
+      return err;
+    }
+
+    bool is_verified_request = license_info.GetLicense() == license_key_ || dclient->IsVerified();
+    if (!is_verified_request) {
+      return common::make_error_inval();
+    }
+
+    daemon_client::ProtocoledDaemonClient* pdclient = static_cast<daemon_client::ProtocoledDaemonClient*>(dclient);
+    std::string stats_str;
+    err = MakeStats(&stats_str);
+    if (err) {
+      protocol::responce_t resp = daemon_client::GetStatsResponceFail(id, err->GetDescription());
+      return pdclient->WriteResponce(resp);
+    }
+
+    protocol::responce_t resp = daemon_client::GetStatsResponceSuccess(id, stats_str);
+    return pdclient->WriteResponce(resp);
+  }
+
+  return common::make_error_inval();
+}
+
+common::Error ProcessWrapper::MakeStats(std::string* serialized) {
+  UNUSED(serialized);
+  return common::make_error("Statistics not supported");
+}
+
+bool ProcessWrapper::IsSupportedEntriesEncoding(const std::string& encoding) const {
+  return encoding == ENTRIES_ENCODING_JSON;
+}
+
 common::Error ProcessWrapper::HandleRequestClientActivate(daemon_client::DaemonClient* dclient,
                                                           protocol::sequance_id_t id,
                                                           int argc,
@@ -290,6 +392,18 @@ common::Error ProcessWrapper::HandleRequestClientActivate(daemon_client::DaemonC
 
     commands_info::ActivateInfo activate_info;
     common::Error err = activate_info.DeSerialize(jactivate);
+    commands_info::ActivateSlaveInfo::id_t slave_id;
+    if (!commands_info::ActivateSlaveInfo::GetID(jactivate, &slave_id)) {
+      slave_id.clear();
+    }
+    std::string entries_encoding;
+    if (!commands_info::ActivateSlaveInfo::GetEntriesEncoding(jactivate, &entries_encoding)) {
+      entries_encoding.clear();
+    }
+    std::string compression;
+    if (!commands_info::ActivateSlaveInfo::GetCompression(jactivate, &compression)) {
+      compression.clear();
+    }
     json_object_put(jactivate);
     if (err) {
       return err;
@@ -301,9 +415,18 @@ common::Error ProcessWrapper::HandleRequestClientActivate(daemon_client::DaemonC
     }
 
     daemon_client::ProtocoledDaemonClient* pdclient = static_cast<daemon_client::ProtocoledDaemonClient*>(dclient);
-    protocol::responce_t resp = daemon_client::ActivateResponceSuccess(id);
+    // plain responce for slaves which asked nothing, unknown choices are answered with defaults
+    const std::string accepted_encoding =
+        IsSupportedEntriesEncoding(entries_encoding) ? entries_encoding : ENTRIES_ENCODING_JSON;
+    const std::string accepted_compression =
+        compression == FRAME_COMPRESSION_ZSTD ? compression : FRAME_COMPRESSION_NONE;
+    protocol::responce_t resp =
+        entries_encoding.empty() && compression.empty()
+            ? daemon_client::ActivateResponceSuccess(id)
+            : daemon_client::ActivateSlaveResponceSuccess(id, accepted_encoding, accepted_compression);
     pdclient->WriteResponce(resp);
     dclient->SetVerified(true);
+    dclient->SetSlaveID(slave_id);
     return common::Error();
   }
 
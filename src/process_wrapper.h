@@ -36,6 +36,7 @@ class ProcessWrapper : public common::libev::IoLoopObserver {
   virtual int Exec(int argc, char** argv);
 
   static int SendStopDaemonRequest(const std::string& license_key, const common::net::HostAndPort& service_host);
+  static int SendGetStatsRequest(const std::string& license_key, const common::net::HostAndPort& service_host);
 
  protected:
   virtual void PreLooped(common::libev::IoLoop* server) override;
@@ -75,6 +76,16 @@ class ProcessWrapper : public common::libev::IoLoopObserver {
                                                        protocol::sequance_id_t id,
                                                        int argc,
                                                        char* argv[]) WARN_UNUSED_RESULT;
+  virtual common::Error HandleRequestClientGetStats(daemon_client::DaemonClient* dclient,
+                                                    protocol::sequance_id_t id,
+                                                    int argc,
+                                                    char* argv[]) WARN_UNUSED_RESULT;
+
+  // entries encodings accepted from activated slaves besides json
+  virtual bool IsSupportedEntriesEncoding(const std::string& encoding) const;
+
+  // serialized snapshot for get_stats command, called in loop thread
+  virtual common::Error MakeStats(std::string* serialized) WARN_UNUSED_RESULT;
 
   common::libev::IoLoop* loop_;
 
@@ -0,0 +1,214 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "protocol/frame_codec.h"
+
+#include <zdict.h>
+#include <zstd.h>
+
+#include <common/sprintf.h>
+#include <common/sys_byteorder.h>
+
+#include "protocol/protocol.h"
+
+namespace sniffer {
+namespace protocol {
+namespace {
+
+static_assert(static_cast<protocoled_size_t>(MAX_COMMAND_SIZE) <= FRAME_SIZE_MASK, "Command size overlaps frame flags");
+
+void AppendFrame(protocoled_size_t flags, const char* payload, size_t size, std::string* frames) {
+  const protocoled_size_t prefix = common::HostToNet32(static_cast<protocoled_size_t>(size) | flags);  // stable
+  frames->append(reinterpret_cast<const char*>(&prefix), sizeof(protocoled_size_t));
+  frames->append(payload, size);
+}
+
+}  // namespace
+
+CompressionStats::CompressionStats() : raw_bytes(0), wire_bytes(0), compressed_frames(0) {}
+
+FrameCodec::FrameCodec()
+    : compress_(false),
+      threshold_(default_threshold),
+      train_dictionary_(false),
+      samples_(),
+      sample_sizes_(),
+      dictionary_(),
+      dictionary_sent_(false),
+      cctx_(nullptr),
+      cdict_(nullptr),
+      dctx_(nullptr),
+      ddict_(nullptr),
+      stats_() {}
+
+FrameCodec::~FrameCodec() {
+  ZSTD_freeDDict(ddict_);
+  ZSTD_freeDCtx(dctx_);
+  ZSTD_freeCDict(cdict_);
+  ZSTD_freeCCtx(cctx_);
+}
+
+void FrameCodec::EnableCompression(size_t threshold, bool train_dictionary) {
+  compress_ = true;
+  threshold_ = threshold;
+  train_dictionary_ = train_dictionary && dictionary_.empty();
+}
+
+bool FrameCodec::IsCompressionEnabled() const {
+  return compress_;
+}
+
+void FrameCodec::SetDictionary(const std::string& dictionary) {
+  dictionary_ = dictionary;
+  train_dictionary_ = false;
+  samples_.clear();
+  sample_sizes_.clear();
+  ResetCompressionDictionary();
+}
+
+std::string FrameCodec::GetDictionary() const {
+  return dictionary_;
+}
+
+void FrameCodec::ResetCompressionDictionary() {
+  ZSTD_freeCDict(cdict_);
+  cdict_ = nullptr;
+  dictionary_sent_ = false;
+  if (!dictionary_.empty()) {
+    cdict_ = ZSTD_createCDict(dictionary_.data(), dictionary_.size(), compression_level);
+  }
+}
+
+void FrameCodec::TrainDictionary(const std::string& command) {
+  samples_.append(command);
+  sample_sizes_.push_back(command.size());
+  if (samples_.size() < dictionary_samples_size) {
+    return;
+  }
+
+  std::string dictionary(dictionary_size, 0);
+  const size_t size = ZDICT_trainFromBuffer(&dictionary[0], dictionary.size(), samples_.data(), sample_sizes_.data(),
+                                            sample_sizes_.size());
+  if (ZDICT_isError(size) || sample_sizes_.size() < dictionary_min_samples) {
+    // few large commands, dictionary would not pay for itself
+    train_dictionary_ = false;
+    samples_.clear();
+    sample_sizes_.clear();
+    return;
+  }
+
+  dictionary.resize(size);
+  SetDictionary(dictionary);
+}
+
+common::Error FrameCodec::Encode(const std::string& command, std::string* frames) {
+  if (command.empty() || !frames) {
+    return common::make_error_inval();
+  }
+
+  if (command.size() > MAX_COMMAND_SIZE) {
+    return common::make_error(common::MemSPrintf("Reached limit of command size: %lu", command.size()));
+  }
+
+  frames->clear();
+  stats_.raw_bytes += command.size();
+  if (!compress_ || command.size() < threshold_) {
+    AppendFrame(0, command.data(), command.size(), frames);
+    stats_.wire_bytes += frames->size();
+    return common::Error();
+  }
+
+  if (train_dictionary_) {
+    TrainDictionary(command);
+  }
+
+  if (!cctx_) {
+    cctx_ = ZSTD_createCCtx();
+    if (!cctx_) {
+      return common::make_error("ZSTD_createCCtx failed");
+    }
+  }
+
+  if (cdict_ && !dictionary_sent_) {
+    AppendFrame(DICTIONARY_FRAME_FLAG, dictionary_.data(), dictionary_.size(), frames);
+    dictionary_sent_ = true;
+  }
+
+  std::string compressed(ZSTD_compressBound(command.size()), 0);
+  char* dst = &compressed[0];
+  const size_t compressed_size =
+      cdict_ ? ZSTD_compress_usingCDict(cctx_, dst, compressed.size(), command.data(), command.size(), cdict_)
+             : ZSTD_compressCCtx(cctx_, dst, compressed.size(), command.data(), command.size(), compression_level);
+  if (ZSTD_isError(compressed_size) || compressed_size >= command.size()) {
+    AppendFrame(0, command.data(), command.size(), frames);
+  } else {
+    AppendFrame(COMPRESSED_FRAME_FLAG, compressed.data(), compressed_size, frames);
+    stats_.compressed_frames++;
+  }
+  stats_.wire_bytes += frames->size();
+  return common::Error();
+}
+
+common::Error FrameCodec::Decode(protocoled_size_t prefix, const char* payload, size_t size, std::string* out) {
+  if (!payload || !out) {
+    return common::make_error_inval();
+  }
+
+  if (prefix & DICTIONARY_FRAME_FLAG) {
+    ZSTD_freeDDict(ddict_);
+    ddict_ = ZSTD_createDDict(payload, size);
+    if (!ddict_) {
+      return common::make_error("Invalid compression dictionary");
+    }
+    out->clear();
+    return common::Error();
+  }
+
+  if (!(prefix & COMPRESSED_FRAME_FLAG)) {
+    *out = std::string(payload, size);
+    return common::Error();
+  }
+
+  const unsigned long long content_size = ZSTD_getFrameContentSize(payload, size);
+  if (content_size == ZSTD_CONTENTSIZE_UNKNOWN || content_size == ZSTD_CONTENTSIZE_ERROR || content_size == 0 ||
+      content_size > MAX_COMMAND_SIZE) {
+    return common::make_error("Invalid compressed frame");
+  }
+
+  if (!dctx_) {
+    dctx_ = ZSTD_createDCtx();
+    if (!dctx_) {
+      return common::make_error("ZSTD_createDCtx failed");
+    }
+  }
+
+  std::string command(content_size, 0);
+  const size_t command_size =
+      ddict_ ? ZSTD_decompress_usingDDict(dctx_, &command[0], command.size(), payload, size, ddict_)
+             : ZSTD_decompressDCtx(dctx_, &command[0], command.size(), payload, size);
+  if (ZSTD_isError(command_size) || command_size != command.size()) {
+    return common::make_error(common::MemSPrintf("Decompress frame error: %s", ZSTD_getErrorName(command_size)));
+  }
+
+  *out = command;
+  return common::Error();
+}
+
+CompressionStats FrameCodec::GetStats() const {
+  return stats_;
+}
+
+}  // namespace protocol
+}  // namespace sniffer
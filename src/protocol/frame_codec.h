@@ -0,0 +1,111 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include <common/error.h>
+#include <common/macros.h>
+
+// values of "compression" in slave activation and in its responce
+#define FRAME_COMPRESSION_NONE "none"
+#define FRAME_COMPRESSION_ZSTD "zstd"
+
+typedef struct ZSTD_CCtx_s ZSTD_CCtx;
+typedef struct ZSTD_DCtx_s ZSTD_DCtx;
+typedef struct ZSTD_CDict_s ZSTD_CDict;
+typedef struct ZSTD_DDict_s ZSTD_DDict;
+
+namespace sniffer {
+namespace protocol {
+
+typedef uint32_t protocoled_size_t;  // sizeof 4 byte
+
+// high bits of length prefix, peers set them only after compression was negotiated
+enum : protocoled_size_t {
+  COMPRESSED_FRAME_FLAG = 0x80000000,  // payload is zstd frame of command
+  DICTIONARY_FRAME_FLAG = 0x40000000,  // payload is zstd dictionary of following compressed frames
+  FRAME_SIZE_MASK = 0x3FFFFFFF
+};
+
+struct CompressionStats {
+  CompressionStats();
+
+  uint64_t raw_bytes;          // commands before compression
+  uint64_t wire_bytes;         // written frames with length prefixes and dictionaries
+  uint64_t compressed_frames;  // frames sent compressed, others were small or incompressible
+};
+
+// per connection zstd state, compression of outgoing frames is off until enabled,
+// incoming compressed and dictionary frames are always accepted
+class FrameCodec {
+ public:
+  enum {
+    default_threshold = 1024,           // smaller commands are sent raw
+    compression_level = 3,              // fast enough for loop thread
+    dictionary_size = 16 * 1024,        // trained on first compressed commands, mac addresses repeat
+    dictionary_samples_size = 256 * 1024,
+    dictionary_min_samples = 16
+  };
+
+  FrameCodec();
+  ~FrameCodec();
+
+  void EnableCompression(size_t threshold, bool train_dictionary);
+  bool IsCompressionEnabled() const;
+
+  // dictionary shared with peer, sent as dictionary frame in front of next compressed frame
+  void SetDictionary(const std::string& dictionary);
+  std::string GetDictionary() const;
+
+  // length prefixed frames for command, dictionary frame may precede it
+  common::Error Encode(const std::string& command, std::string* frames) WARN_UNUSED_RESULT;
+  // payload of frame with given length prefix, empty out for dictionary frame
+  common::Error Decode(protocoled_size_t prefix,
+                       const char* payload,
+                       size_t size,
+                       std::string* out) WARN_UNUSED_RESULT;
+
+  CompressionStats GetStats() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(FrameCodec);
+
+  void TrainDictionary(const std::string& command);
+  void ResetCompressionDictionary();
+
+  bool compress_;
+  size_t threshold_;
+  bool train_dictionary_;
+  std::string samples_;
+  std::vector<size_t> sample_sizes_;
+
+  std::string dictionary_;
+  bool dictionary_sent_;
+
+  ZSTD_CCtx* cctx_;
+  ZSTD_CDict* cdict_;
+  ZSTD_DCtx* dctx_;
+  ZSTD_DDict* ddict_;  // last dictionary received from peer
+
+  CompressionStats stats_;
+};
+
+}  // namespace protocol
+}  // namespace sniffer
@@ -52,26 +52,40 @@ common::Error GenerateProtocoledMessage(const std::string& message, char** data,
 }  // namespace
 
 namespace detail {
+// one Read can return only part of a large frame, keep reading until it is complete
+common::Error ReadExactly(common::libev::IoClient* client, char* out, size_t size) {
+  size_t total = 0;
+  while (total != size) {
+    size_t nread = 0;
+    common::Error err = client->Read(out + total, size - total, &nread);
+    if (err) {
+      return err;
+    }
+
+    if (nread == 0) {  // connection closed
+      if (total == 0) {
+        return common::make_error("Connection closed");
+      }
+      return common::make_error(
+          common::MemSPrintf("Error when reading needed to read: %lu bytes, but readed: %lu", size, total));
+    }
+    total += nread;
+  }
+
+  return common::Error();
+}
+
 common::Error ReadDataSize(common::libev::IoClient* client, protocoled_size_t* sz) {
   if (!client || !sz) {
     return common::make_error_inval();
   }
 
   protocoled_size_t lsz = 0;
-  size_t nread = 0;
-  common::Error err = client->Read(reinterpret_cast<char*>(&lsz), sizeof(protocoled_size_t), &nread);
+  common::Error err = ReadExactly(client, reinterpret_cast<char*>(&lsz), sizeof(protocoled_size_t));
   if (err) {
     return err;
   }
 
-  if (nread != sizeof(protocoled_size_t)) {  // connection closed
-    if (nread == 0) {
-      return common::make_error("Connection closed");
-    }
-    return common::make_error(common::MemSPrintf("Error when reading needed to read: %lu bytes, but readed: %lu",
-                                                 sizeof(protocoled_size_t), nread));
-  }
-
   *sz = lsz;
   return common::Error();
 }
@@ -81,39 +95,30 @@ common::Error ReadMessage(common::libev::IoClient* client, char* out, protocoled
     return common::make_error_inval();
   }
 
-  size_t nread;
-  common::Error err = client->Read(out, size, &nread);
-  if (err) {
-    return err;
-  }
-
-  if (nread != size) {  // connection closed
-    if (nread == 0) {
-      return common::make_error("Connection closed");
-    }
-    return common::make_error(
-        common::MemSPrintf("Error when reading needed to read: %lu bytes, but readed: %lu", size, nread));
-  }
-
-  return common::Error();
+  return ReadExactly(client, out, size);
 }
 
-common::Error ReadCommand(common::libev::IoClient* client, std::string* out) {
+common::Error ReadCommand(common::libev::IoClient* client, FrameCodec* codec, std::string* out) {
   if (!client || !out) {
     return common::make_error_inval();
   }
 
-  protocoled_size_t message_size;
-  common::Error err = ReadDataSize(client, &message_size);
+  protocoled_size_t prefix;
+  common::Error err = ReadDataSize(client, &prefix);
   if (err) {
     return err;
   }
 
-  message_size = common::NetToHost32(message_size);  // stable
+  prefix = common::NetToHost32(prefix);  // stable
+  const protocoled_size_t message_size = prefix & FRAME_SIZE_MASK;
   if (message_size > MAX_COMMAND_SIZE) {
     return common::make_error(common::MemSPrintf("Reached limit of command size: %u", message_size));
   }
 
+  if (!codec && (prefix & ~FRAME_SIZE_MASK)) {
+    return common::make_error("Compressed frame on connection without compression");
+  }
+
   char* msg = static_cast<char*>(malloc(message_size));
   err = ReadMessage(client, msg, message_size);
   if (err) {
@@ -121,6 +126,12 @@ common::Error ReadCommand(common::libev::IoClient* client, std::string* out) {
     return err;
   }
 
+  if (codec) {
+    err = codec->Decode(prefix, msg, message_size, out);
+    free(msg);
+    return err;
+  }
+
   std::string un_compressed(msg, message_size);
   free(msg);
 
@@ -128,7 +139,27 @@ common::Error ReadCommand(common::libev::IoClient* client, std::string* out) {
   return common::Error();
 }
 
-common::Error WriteMessage(common::libev::IoClient* client, const std::string& message) {
+common::Error WriteFrames(common::libev::IoClient* client, const char* protocoled_data, size_t protocoled_data_len) {
+  size_t nwrite = 0;
+  common::Error err = client->Write(protocoled_data, protocoled_data_len, &nwrite);
+  if (nwrite != protocoled_data_len) {  // connection closed
+    return common::make_error(
+        common::MemSPrintf("Error when writing needed to write: %lu, but writed: %lu", protocoled_data_len, nwrite));
+  }
+
+  return err;
+}
+
+common::Error WriteMessage(common::libev::IoClient* client, FrameCodec* codec, const std::string& message) {
+  if (codec) {
+    std::string frames;
+    common::Error err = codec->Encode(message, &frames);
+    if (err) {
+      return err;
+    }
+    return WriteFrames(client, frames.data(), frames.size());
+  }
+
   char* protocoled_data = NULL;
   size_t protocoled_data_len = 0;
   common::Error err = protocol::GenerateProtocoledMessage(message, &protocoled_data, &protocoled_data_len);
@@ -136,23 +167,17 @@ common::Error WriteMessage(common::libev::IoClient* client, const std::string& m
     return err;
   }
 
-  size_t nwrite = 0;
-  err = client->Write(protocoled_data, protocoled_data_len, &nwrite);
+  err = WriteFrames(client, protocoled_data, protocoled_data_len);
   free(protocoled_data);
-  if (nwrite != protocoled_data_len) {  // connection closed
-    return common::make_error(
-        common::MemSPrintf("Error when writing needed to write: %lu, but writed: %lu", protocoled_data_len, nwrite));
-  }
-
   return err;
 }
 
-common::Error WriteRequest(common::libev::IoClient* client, const request_t& request) {
-  return WriteMessage(client, request.GetCmd());
+common::Error WriteRequest(common::libev::IoClient* client, FrameCodec* codec, const request_t& request) {
+  return WriteMessage(client, codec, request.GetCmd());
 }
 
-common::Error WriteResponce(common::libev::IoClient* client, const responce_t& responce) {
-  return WriteMessage(client, responce.GetCmd());
+common::Error WriteResponce(common::libev::IoClient* client, FrameCodec* codec, const responce_t& responce) {
+  return WriteMessage(client, codec, responce.GetCmd());
 }
 }  // namespace detail
 
@@ -16,39 +16,46 @@
 
 #include <common/libev/io_client.h>
 
+#include "protocol/frame_codec.h"
 #include "protocol/types.h"
 
 namespace sniffer {
 namespace protocol {
 
-typedef uint32_t protocoled_size_t;  // sizeof 4 byte
-enum { MAX_COMMAND_SIZE = 1024 * 8 };
+enum { MAX_COMMAND_SIZE = 1024 * 1024 };  // fits batch of entries, see SLAVE_SEND_ENTRIES
 
 namespace detail {
-common::Error WriteRequest(common::libev::IoClient* client, const request_t& request) WARN_UNUSED_RESULT;
-common::Error WriteResponce(common::libev::IoClient* client, const responce_t& responce) WARN_UNUSED_RESULT;
-common::Error ReadCommand(common::libev::IoClient* client, std::string* out) WARN_UNUSED_RESULT;
+// codec can be NULL, then frames are raw and flagged frames are rejected
+common::Error WriteRequest(common::libev::IoClient* client,
+                           FrameCodec* codec,
+                           const request_t& request) WARN_UNUSED_RESULT;
+common::Error WriteResponce(common::libev::IoClient* client,
+                            FrameCodec* codec,
+                            const responce_t& responce) WARN_UNUSED_RESULT;
+// empty out for control frames without command
+common::Error ReadCommand(common::libev::IoClient* client, FrameCodec* codec, std::string* out) WARN_UNUSED_RESULT;
 }  // namespace detail
 
+// Client provides FrameCodec* GetFrameCodec()
 template <typename Client>
 class ProtocolClient : public Client {
  public:
   common::Error WriteRequest(const request_t& request) WARN_UNUSED_RESULT {
-    return detail::WriteRequest(this, request);
+    return detail::WriteRequest(this, Client::GetFrameCodec(), request);
   }
 
   common::Error WriteResponce(const responce_t& responce) WARN_UNUSED_RESULT {
-    return detail::WriteResponce(this, responce);
+    return detail::WriteResponce(this, Client::GetFrameCodec(), responce);
   }
 
-  common::Error ReadCommand(std::string* out) WARN_UNUSED_RESULT { return detail::ReadCommand(this, out); }
+  common::Error ReadCommand(std::string* out) WARN_UNUSED_RESULT {
+    return detail::ReadCommand(this, Client::GetFrameCodec(), out);
+  }
 
  private:
   using Client::Read;
   using Client::Write;
 };
 
-typedef protocol::ProtocolClient<common::libev::IoClient> protocol_client_t;
-
 }  // namespace protocol
 }  // namespace iptv_cloud
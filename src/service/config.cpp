@@ -26,17 +26,20 @@
 #define CONFIG_SERVER_DB_HOSTS_FIELD "db_hosts"
 #define CONFIG_SERVER_SCANING_PATH_FIELD "scaning_paths"
 #define CONFIG_SERVER_ARCHIVE_PATH_FIELD "archive_path"
+#define CONFIG_SERVER_PARALLEL_PARSE_THRESHOLD_FIELD "parallel_parse_threshold"
 
 #define DEFAULT_ID_FIELD_VALUE "localhost"
 #define DEFAULT_DB_HOSTS_FIELD_VALUE "127.0.0.1"
 #define DEFAULT_SCANING_PATH_FIELD_VALUE "~/" SERVICE_NAME
 #define DEFAULT_ARCHIVE_PATH_FIELD_VALUE "~/" SERVICE_NAME "/archive"
+#define DEFAULT_PARALLEL_PARSE_THRESHOLD_FIELD_VALUE (256 * 1024 * 1024)
 
 /*
   [server]
   id=localhost
   db_hosts=127.0.0.1
   scaning_paths=~/sniffer
+  parallel_parse_threshold=268435456
 */
 
 #define MATCH_FIELD(s, n) strcmp(section, s) == 0 && strcmp(name, n) == 0
@@ -70,6 +73,12 @@ int ini_handler_fasto(void* user_data, const char* section, const char* name, co
   } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_ARCHIVE_PATH_FIELD)) {
     pconfig->server.archive_path = common::file_system::ascii_directory_string_path(value);
     return 1;
+  } else if (MATCH_FIELD(CONFIG_SERVER, CONFIG_SERVER_PARALLEL_PARSE_THRESHOLD_FIELD)) {
+    size_t threshold;
+    if (common::ConvertFromString(value, &threshold)) {
+      pconfig->server.parallel_parse_threshold = threshold;
+    }
+    return 1;
   } else {
     return 0; /* unknown section/name, error */
   }
@@ -80,7 +89,8 @@ ServerSettings::ServerSettings()
     : id(DEFAULT_ID_FIELD_VALUE),
       db_hosts{DEFAULT_DB_HOSTS_FIELD_VALUE},
       scaning_paths{common::file_system::ascii_directory_string_path(DEFAULT_SCANING_PATH_FIELD_VALUE)},
-      archive_path(DEFAULT_ARCHIVE_PATH_FIELD_VALUE) {}
+      archive_path(DEFAULT_ARCHIVE_PATH_FIELD_VALUE),
+      parallel_parse_threshold(DEFAULT_PARALLEL_PARSE_THRESHOLD_FIELD_VALUE) {}
 
 Config::Config() : server() {}
 
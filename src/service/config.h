@@ -31,6 +31,7 @@ struct ServerSettings {
   std::vector<std::string> db_hosts;
   std::vector<common::file_system::ascii_directory_string_path> scaning_paths;
   common::file_system::ascii_directory_string_path archive_path;
+  size_t parallel_parse_threshold;  // bytes, classic pcap files from this size are parsed in chunks, 0 - disabled
 };
 
 struct Config {
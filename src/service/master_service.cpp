@@ -14,12 +14,20 @@
 
 #include "service/master_service.h"
 
+#include <string.h>
 #include <sys/inotify.h>
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
 #include <common/file_system/file_system.h>
 #include <common/file_system/string_path_utils.h>
 #include <common/libev/io_loop.h>
 
+#include "commands_info/entries_binary.h"
+#include "commands_info/entries_info.h"
+#include "commands_info/stats_info.h"
 #include "commands_info/stop_service_info.h"
 
 #include "service/folder_change_reader.h"
@@ -50,6 +58,7 @@ class Pcaper : public sniffer::FileSniffer {
   entries_t GetEntries() const { return entries_; }
   common::utctime_t GetTSFile() const { return ts_file_; }
   void AddEntry(const entry_t& entry) { entries_.push_back(entry); }
+  entries_t* GetEntriesBuffer() { return &entries_; }
 
  private:
   common::utctime_t ts_file_;
@@ -194,53 +203,173 @@ void MasterService::HandlePcapFile(const common::file_system::ascii_directory_st
       return;
     }
 
-    Pcaper pcap(common::time::tm2utctime(&tm), path, this);
+    const common::utctime_t ts_file = common::time::tm2utctime(&tm);
+    Pcaper pcap(ts_file, path, this);
     common::Error err = pcap.Open();
     if (err) {
       return;
     }
 
+    // compressed files are detected by magic, not by extension, and inflate as a single stream
+    const size_t threshold = config_.server.parallel_parse_threshold;
+    if (pcap.IsCompressed()) {
+      INFO_LOG() << "Inflating compressed pcap file: " << path.GetPath();
+    } else if (threshold && pcap.GetFileSize() >= threshold && !pcap.IsPcapng()) {
+      std::vector<size_t> bounds = SplitPcapFile(&pcap);
+      if (bounds.size() > 2) {
+        HandlePcapFileChunks(node, path, ts_file, bounds, &pcap);
+        return;
+      }
+    }
+
     pcap.Run();
-    pcap.Close();
-    TouchEntries(node, pcap.GetEntries());
+    err = pcap.Close();
+    FinishPcapFile(node, path, pcap.GetEntries());
+  };
 
-#if 0
-    // archive file
-    std::string table_name = node.GetFolderName();
-    auto path_to_folder = config_.server.archive_path.MakeDirectoryStringPath(table_name);
-    if (path_to_folder) {
-      common::file_system::ascii_directory_string_path archive_dir = *path_to_folder;
-      std::string archive_dir_str = archive_dir.GetPath();
-      bool is_exist_archive_dir = common::file_system::is_directory_exist(archive_dir_str);
-      if (!is_exist_archive_dir) {
-        common::ErrnoError errn = common::file_system::create_directory(archive_dir_str, true);
-        if (errn) {
-          DEBUG_MSG_ERROR(errn, common::logging::LOG_LEVEL_WARNING);
-        } else {
-          is_exist_archive_dir = true;
-        }
-      }
+  thread_pool_.Post(pcap_task);
+}
 
-      if (is_exist_archive_dir) {
-        auto path_to = archive_dir.MakeFileStringPath(path.GetBaseFileName() + ARCHIVE_EXTENSION);
-        err = archive::MakeArchive(path, *path_to);
-        if (err) {
-          DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
-        }
+std::vector<size_t> MasterService::SplitPcapFile(sniffer::FileSniffer* pcap) const {
+  const size_t size = pcap->GetFileSize();
+  const size_t header = pcap->GetHeaderSize();
+  const size_t chunks = std::min<size_t>(thread_pool_size, std::max<size_t>(1, (size - header) / min_chunk_size));
+
+  std::vector<size_t> bounds;
+  bounds.push_back(header);
+  for (size_t i = 1; i < chunks; ++i) {
+    size_t offset;
+    if (pcap->FindRecordBoundary(header + i * (size - header) / chunks, &offset) && offset > bounds.back() &&
+        offset < size) {
+      bounds.push_back(offset);
+    }
+  }
+  bounds.push_back(size);
+  return bounds;
+}
+
+void MasterService::HandlePcapFileChunks(const common::file_system::ascii_directory_string_path& node,
+                                         const common::file_system::ascii_file_string_path& path,
+                                         common::utctime_t ts_file,
+                                         const std::vector<size_t>& bounds,
+                                         sniffer::FileSniffer* first) {
+  const size_t chunks = bounds.size() - 1;
+  INFO_LOG() << "Parse pcap file in " << chunks << " chunks, path: " << path.GetPath();
+
+  // every chunk fills own slot, last finished one merges them in file order
+  struct ChunkedPcapFile {
+    explicit ChunkedPcapFile(size_t chunks) : entries(chunks), pending(chunks), failed(false) {}
+
+    std::vector<Pcaper::entries_t> entries;
+    std::atomic<size_t> pending;
+    std::atomic<bool> failed;  // some chunk was not parsed, merge would lose its sightings
+  };
+  std::shared_ptr<ChunkedPcapFile> state = std::make_shared<ChunkedPcapFile>(chunks);
+  auto chunk_done = [this, node, path, ts_file, state](size_t chunk, Pcaper::entries_t* entries, bool parsed) {
+    state->entries[chunk].swap(*entries);
+    if (!parsed) {
+      state->failed.store(true, std::memory_order_relaxed);
+    }
+    if (state->pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      return;
+    }
+
+    if (state->failed.load(std::memory_order_relaxed)) {
+      // whole file is parsed again, it stays in place if that fails too
+      WARNING_LOG() << "Chunked parse failed, parse pcap file serially, path: " << path.GetPath();
+      Pcaper pcap(ts_file, path, this);
+      common::Error err = pcap.Open();
+      if (err) {
+        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+        return;
       }
-    } else {
-      // Can't generate archive folder
+
+      pcap.Run();
+      err = pcap.Close();
+      FinishPcapFile(node, path, pcap.GetEntries());
+      return;
     }
-#endif
 
-    // remove file
-    common::ErrnoError errn = common::file_system::remove_file(path.GetPath());
-    if (errn) {
-      DEBUG_MSG_ERROR(errn, common::logging::LOG_LEVEL_WARNING);
+    Pcaper::entries_t merged;
+    for (size_t i = 0; i < state->entries.size(); ++i) {
+      merged.insert(merged.end(), state->entries[i].begin(), state->entries[i].end());
     }
+    FinishPcapFile(node, path, merged);
   };
 
-  thread_pool_.Post(pcap_task);
+  for (size_t i = 1; i < chunks; ++i) {
+    const size_t begin = bounds[i];
+    const size_t end = bounds[i + 1];
+    auto chunk_task = [this, path, ts_file, begin, end, i, chunk_done]() {
+      Pcaper pcap(ts_file, path, this);
+      common::Error err = pcap.Open();
+      if (!err) {
+        err = pcap.SetRange(begin, end);
+      }
+      const bool parsed = !err;
+      if (err) {
+        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+      } else {
+        pcap.Run();
+        err = pcap.Close();
+      }
+      chunk_done(i, pcap.GetEntriesBuffer(), parsed);
+    };
+    thread_pool_.Post(chunk_task);
+  }
+
+  // first chunk on current task
+  Pcaper* pcap = static_cast<Pcaper*>(first);
+  common::Error err = pcap->SetRange(bounds[0], bounds[1]);
+  const bool parsed = !err;
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+  } else {
+    pcap->Run();
+  }
+  err = pcap->Close();
+  chunk_done(0, pcap->GetEntriesBuffer(), parsed);
+}
+
+void MasterService::FinishPcapFile(const common::file_system::ascii_directory_string_path& node,
+                                   const common::file_system::ascii_file_string_path& path,
+                                   const std::vector<EntryInfo>& entries) {
+  TouchEntries(node, entries);
+
+#if 0
+  // archive file
+  std::string table_name = node.GetFolderName();
+  auto path_to_folder = config_.server.archive_path.MakeDirectoryStringPath(table_name);
+  if (path_to_folder) {
+    common::file_system::ascii_directory_string_path archive_dir = *path_to_folder;
+    std::string archive_dir_str = archive_dir.GetPath();
+    bool is_exist_archive_dir = common::file_system::is_directory_exist(archive_dir_str);
+    if (!is_exist_archive_dir) {
+      common::ErrnoError errn = common::file_system::create_directory(archive_dir_str, true);
+      if (errn) {
+        DEBUG_MSG_ERROR(errn, common::logging::LOG_LEVEL_WARNING);
+      } else {
+        is_exist_archive_dir = true;
+      }
+    }
+
+    if (is_exist_archive_dir) {
+      auto path_to = archive_dir.MakeFileStringPath(path.GetBaseFileName() + ARCHIVE_EXTENSION);
+      common::Error err = archive::MakeArchive(path, *path_to);
+      if (err) {
+        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
+      }
+    }
+  } else {
+    // Can't generate archive folder
+  }
+#endif
+
+  // remove file
+  common::ErrnoError errn = common::file_system::remove_file(path.GetPath());
+  if (errn) {
+    DEBUG_MSG_ERROR(errn, common::logging::LOG_LEVEL_WARNING);
+  }
 }
 
 void MasterService::TouchEntries(const common::file_system::ascii_directory_string_path& path,
@@ -267,25 +396,27 @@ void MasterService::HandleEntries(const common::file_system::ascii_directory_str
 }
 
 void MasterService::HandlePacket(sniffer::ISniffer* sniffer, const u_char* packet, const pcap_pkthdr* header) {
-  EntryInfo ent;
+  sniffer::Packet single;
+  single.header = *header;
+  single.data = packet;
+  HandlePackets(sniffer, &single, 1);
+}
+
+void MasterService::HandlePackets(sniffer::ISniffer* sniffer, const sniffer::Packet* packets, size_t count) {
   Pcaper* pcaper = static_cast<Pcaper*>(sniffer);
-  if (pcaper->GetLinkHeaderType() == DLT_IEEE802_11_RADIO) {
-    PARSE_RESULT res = MakeEntryFromRadioTap(packet, header, &ent);
-    if (res != PARSE_OK) {
-      return;
-    }
-  } else if (pcaper->GetLinkHeaderType() == DLT_EN10MB) {
-    PARSE_RESULT res = MakeEntryFromEthernet(packet, header, &ent);
-    if (res != PARSE_OK) {
-      return;
-    }
-  } else {
+  Pcaper::entries_t* entries = pcaper->GetEntriesBuffer();
+  const size_t start = entries->size();
+  const LinkDecoder* decoder = pcaper->GetDecoder();
+  if (!decoder) {
     return;
   }
+  decoder->parse(packets, count, entries, nullptr);
 
   // pcaper->GetTSFile() * 1000
-  ent.SetTimestamp((ent.GetTimestamp() / 1000) * 1000);
-  pcaper->AddEntry(ent);
+  for (size_t i = start; i < entries->size(); ++i) {
+    EntryInfo* ent = &(*entries)[i];
+    ent->SetTimestamp((ent->GetTimestamp() / 1000) * 1000);
+  }
 }
 
 common::Error MasterService::HandleRequestServiceCommand(daemon_client::DaemonClient* dclient,
@@ -295,6 +426,12 @@ common::Error MasterService::HandleRequestServiceCommand(daemon_client::DaemonCl
   char* command = argv[0];
   if (IS_EQUAL_COMMAND(command, SLAVE_SEND_ENTRY)) {
     return HandleRequestEntryFromSlave(dclient, id, argc, argv);
+  } else if (IS_EQUAL_COMMAND(command, SLAVE_SEND_ENTRIES_BINARY)) {  // before SLAVE_SEND_ENTRIES, prefix match
+    return HandleRequestEntriesBinaryFromSlave(dclient, id, argc, argv);
+  } else if (IS_EQUAL_COMMAND(command, SLAVE_SEND_ENTRIES)) {
+    return HandleRequestEntriesFromSlave(dclient, id, argc, argv);
+  } else if (IS_EQUAL_COMMAND(command, SLAVE_SEND_STATS)) {
+    return HandleRequestStatsFromSlave(dclient, id, argc, argv);
   }
 
   return base_class::HandleRequestServiceCommand(dclient, id, argc, argv);
@@ -307,6 +444,10 @@ common::Error MasterService::HandleResponceServiceCommand(daemon_client::DaemonC
   return base_class::HandleResponceServiceCommand(dclient, id, argc, argv);
 }
 
+bool MasterService::IsSupportedEntriesEncoding(const std::string& encoding) const {
+  return encoding == ENTRIES_ENCODING_BINARY || base_class::IsSupportedEntriesEncoding(encoding);
+}
+
 common::Error MasterService::HandleRequestEntryFromSlave(daemon_client::DaemonClient* dclient,
                                                          protocol::sequance_id_t id,
                                                          int argc,
@@ -331,12 +472,147 @@ common::Error MasterService::HandleRequestEntryFromSlave(daemon_client::DaemonCl
     }
 
     daemon_client::ProtocoledDaemonClient* pdclient = static_cast<daemon_client::ProtocoledDaemonClient*>(dclient);
+    err = HandleSlaveEntries(dclient, std::vector<EntryInfo>(1, entry_info));
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+      protocol::responce_t resp = daemon_client::EntrySlaveResponceFail(id, err->GetDescription());
+      return pdclient->WriteResponce(resp);
+    }
+
     protocol::responce_t resp = daemon_client::EntrySlaveResponceSuccess(id);
-    pdclient->WriteResponce(resp);
-    return common::Error();
+    return pdclient->WriteResponce(resp);
   }
 
   return common::Error();
 }
+
+common::Error MasterService::HandleRequestEntriesFromSlave(daemon_client::DaemonClient* dclient,
+                                                           protocol::sequance_id_t id,
+                                                           int argc,
+                                                           char* argv[]) {
+  CHECK(loop_->IsLoopThread());
+  if (argc > 1) {
+    bool is_verified_request = dclient->IsVerified();
+    if (!is_verified_request) {
+      return common::make_error_inval();
+    }
+
+    json_object* jentries = json_tokener_parse(argv[1]);
+    if (!jentries) {
+      return common::make_error_inval();
+    }
+
+    commands_info::EntriesInfo entries_info;
+    common::Error err = entries_info.DeSerialize(jentries);
+    json_object_put(jentries);
+    if (err) {
+      return err;
+    }
+
+    daemon_client::ProtocoledDaemonClient* pdclient = static_cast<daemon_client::ProtocoledDaemonClient*>(dclient);
+    err = HandleSlaveEntries(dclient, entries_info.GetEntries());
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+      protocol::responce_t resp = daemon_client::EntriesSlaveResponceFail(id, err->GetDescription());
+      return pdclient->WriteResponce(resp);
+    }
+
+    protocol::responce_t resp = daemon_client::EntriesSlaveResponceSuccess(id);
+    return pdclient->WriteResponce(resp);
+  }
+
+  return common::make_error_inval();
+}
+
+common::Error MasterService::HandleRequestEntriesBinaryFromSlave(daemon_client::DaemonClient* dclient,
+                                                                 protocol::sequance_id_t id,
+                                                                 int argc,
+                                                                 char* argv[]) {
+  CHECK(loop_->IsLoopThread());
+  if (argc > 1) {
+    bool is_verified_request = dclient->IsVerified();
+    if (!is_verified_request) {
+      return common::make_error_inval();
+    }
+
+    std::vector<EntryInfo> entries;
+    common::Error err = commands_info::DecodeEntriesBinary(argv[1], strlen(argv[1]), &entries);
+    if (err) {
+      return err;
+    }
+
+    daemon_client::ProtocoledDaemonClient* pdclient = static_cast<daemon_client::ProtocoledDaemonClient*>(dclient);
+    err = HandleSlaveEntries(dclient, entries);
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+      protocol::responce_t resp = daemon_client::EntriesBinarySlaveResponceFail(id, err->GetDescription());
+      return pdclient->WriteResponce(resp);
+    }
+
+    protocol::responce_t resp = daemon_client::EntriesBinarySlaveResponceSuccess(id);
+    return pdclient->WriteResponce(resp);
+  }
+
+  return common::make_error_inval();
+}
+
+common::Error MasterService::HandleSlaveEntries(daemon_client::DaemonClient* dclient,
+                                                const std::vector<EntryInfo>& entries) {
+  CHECK(loop_->IsLoopThread());
+  if (entries.empty()) {
+    return common::Error();
+  }
+
+  const std::string slave_id = dclient->GetSlaveID();
+  if (slave_id.empty()) {
+    return common::make_error("Slave is not activated");
+  }
+
+  SnifferDB* node = nullptr;
+  if (!db_->FindNode(slave_id, &node)) {
+    return common::make_error("Unknown slave: " + slave_id);
+  }
+
+  return node->Insert(entries);  // one batch statement for whole request
+}
+
+common::Error MasterService::HandleRequestStatsFromSlave(daemon_client::DaemonClient* dclient,
+                                                         protocol::sequance_id_t id,
+                                                         int argc,
+                                                         char* argv[]) {
+  CHECK(loop_->IsLoopThread());
+  if (argc > 1) {
+    bool is_verified_request = dclient->IsVerified();
+    if (!is_verified_request) {
+      return common::make_error_inval();
+    }
+
+    json_object* jstats = json_tokener_parse(argv[1]);
+    if (!jstats) {
+      return common::make_error_inval();
+    }
+
+    commands_info::StatsInfo stats_info;
+    common::Error err = stats_info.DeSerialize(jstats);
+    json_object_put(jstats);
+    if (err) {
+      return err;
+    }
+
+    const commands_info::StatsInfo::capture_t total = stats_info.GetTotalCapture();
+    const ParseStats parse = stats_info.GetParseStats();
+    INFO_LOG() << "Slave[" << stats_info.GetID() << "] capture workers: " << stats_info.GetCaptures().size()
+               << ", received: " << total.received << ", dropped: " << total.dropped
+               << ", interface dropped: " << total.if_dropped << ", parsed ok: " << parse.results[PARSE_OK]
+               << ", uplink raw bytes: " << stats_info.GetUplink().raw_bytes
+               << ", wire bytes: " << stats_info.GetUplink().wire_bytes;
+
+    daemon_client::ProtocoledDaemonClient* pdclient = static_cast<daemon_client::ProtocoledDaemonClient*>(dclient);
+    protocol::responce_t resp = daemon_client::StatsSlaveResponceSuccess(id);
+    return pdclient->WriteResponce(resp);
+  }
+
+  return common::make_error_inval();
+}
 }
 }
@@ -23,6 +23,9 @@
 #include "entry_info.h"
 
 namespace sniffer {
+namespace sniffer {
+class FileSniffer;
+}
 namespace service {
 class FolderChangeReader;
 class DatabaseHolder;
@@ -30,7 +33,12 @@ class DatabaseHolder;
 class MasterService : public ProcessWrapper, public sniffer::ISnifferObserver {
  public:
   typedef ProcessWrapper base_class;
-  enum { cleanup_seconds = 5, thread_pool_size = 3, client_port = 6317 };
+  enum {
+    cleanup_seconds = 5,
+    thread_pool_size = 3,
+    client_port = 6317,
+    min_chunk_size = 1 << 26  // smallest part of pcap file parsed by one task
+  };
   MasterService(const std::string& license_key);
   virtual ~MasterService();
 
@@ -52,6 +60,7 @@ class MasterService : public ProcessWrapper, public sniffer::ISnifferObserver {
   virtual void HandlePacket(sniffer::ISniffer* sniffer,
                             const u_char* packet,
                             const struct pcap_pkthdr* header) override;
+  virtual void HandlePackets(sniffer::ISniffer* sniffer, const sniffer::Packet* packets, size_t count) override;
 
   virtual common::Error HandleRequestServiceCommand(daemon_client::DaemonClient* dclient,
                                                     protocol::sequance_id_t id,
@@ -61,15 +70,44 @@ class MasterService : public ProcessWrapper, public sniffer::ISnifferObserver {
                                                      protocol::sequance_id_t id,
                                                      int argc,
                                                      char* argv[]) override WARN_UNUSED_RESULT;
+  virtual bool IsSupportedEntriesEncoding(const std::string& encoding) const override;
 
   virtual common::Error HandleRequestEntryFromSlave(daemon_client::DaemonClient* dclient,
                                                     protocol::sequance_id_t id,
                                                     int argc,
                                                     char* argv[]) WARN_UNUSED_RESULT;
+  virtual common::Error HandleRequestEntriesFromSlave(daemon_client::DaemonClient* dclient,
+                                                      protocol::sequance_id_t id,
+                                                      int argc,
+                                                      char* argv[]) WARN_UNUSED_RESULT;
+  virtual common::Error HandleRequestEntriesBinaryFromSlave(daemon_client::DaemonClient* dclient,
+                                                            protocol::sequance_id_t id,
+                                                            int argc,
+                                                            char* argv[]) WARN_UNUSED_RESULT;
+  virtual common::Error HandleRequestStatsFromSlave(daemon_client::DaemonClient* dclient,
+                                                    protocol::sequance_id_t id,
+                                                    int argc,
+                                                    char* argv[]) WARN_UNUSED_RESULT;
 
  private:
   void TouchEntries(const common::file_system::ascii_directory_string_path& path,
                     const std::vector<EntryInfo>& entries);
+  // stores entries of slave in table named by its id
+  // slave is answered with success only if entries are stored
+  common::Error HandleSlaveEntries(daemon_client::DaemonClient* dclient,
+                                   const std::vector<EntryInfo>& entries) WARN_UNUSED_RESULT;
+
+  // record aligned chunk bounds of classic pcap file, first is header size, last is file size
+  std::vector<size_t> SplitPcapFile(sniffer::FileSniffer* pcap) const;
+  void HandlePcapFileChunks(const common::file_system::ascii_directory_string_path& node,
+                            const common::file_system::ascii_file_string_path& path,
+                            common::utctime_t ts_file,
+                            const std::vector<size_t>& bounds,
+                            sniffer::FileSniffer* first);
+  // stores entries of parsed file and removes it
+  void FinishPcapFile(const common::file_system::ascii_directory_string_path& node,
+                      const common::file_system::ascii_file_string_path& path,
+                      const std::vector<EntryInfo>& entries);
 
   common::Error FolderChanged(FolderChangeReader* fclient) WARN_UNUSED_RESULT;
 
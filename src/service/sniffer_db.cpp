@@ -36,7 +36,7 @@ namespace sniffer {
 namespace service {
 namespace {
 void init_insert(const EntryInfo& entry, CassStatement* statement) {
-  std::string mac_str = entry.GetMacAddress();
+  const std::string mac_str = entry.GetMacAddress().ToString();  // column stays text
   CassError err = cass_statement_bind_string(statement, 0, mac_str.c_str());
   DCHECK(err == CASS_OK) << "error: " << err;
   err = cass_statement_bind_int64(statement, 1, entry.GetTimestamp());
@@ -0,0 +1,296 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "sniffer/file_decompressor.h"
+
+#include <zlib.h>
+#include <zstd.h>
+
+#include <algorithm>
+
+namespace sniffer {
+namespace sniffer {
+
+namespace {
+const u_char kGzipMagic[] = {0x1f, 0x8b};
+const u_char kZstdMagic[] = {0x28, 0xb5, 0x2f, 0xfd};
+const size_t kMaxInflateInput = 1 << 30;  // z_stream counters are 32 bit
+}  // namespace
+
+FileDecompressor::Codec FileDecompressor::DetectCodec(const u_char* data, size_t size) {
+  if (size >= sizeof(kZstdMagic) && memcmp(data, kZstdMagic, sizeof(kZstdMagic)) == 0) {
+    return ZSTD_CODEC;
+  }
+  if (size >= sizeof(kGzipMagic) && memcmp(data, kGzipMagic, sizeof(kGzipMagic)) == 0) {
+    return GZIP_CODEC;
+  }
+  return NO_CODEC;
+}
+
+common::Error FileDecompressor::Peek(Codec codec,
+                                     const u_char* input,
+                                     size_t input_size,
+                                     u_char* out,
+                                     size_t out_size,
+                                     size_t* out_read) {
+  if (!input || !out || !out_read || codec == NO_CODEC) {
+    return common::make_error_inval();
+  }
+
+  if (codec == ZSTD_CODEC) {
+    ZSTD_DStream* stream = ZSTD_createDStream();
+    if (!stream) {
+      return common::make_error("ZSTD_createDStream failed");
+    }
+    ZSTD_initDStream(stream);
+
+    ZSTD_inBuffer in = {input, input_size, 0};
+    ZSTD_outBuffer zout = {out, out_size, 0};
+    common::Error err;
+    while (zout.pos < zout.size && in.pos < in.size) {
+      const size_t hint = ZSTD_decompressStream(stream, &zout, &in);
+      if (ZSTD_isError(hint)) {
+        err = common::make_error(ZSTD_getErrorName(hint));
+        break;
+      }
+      if (hint == 0) {  // frame finished
+        break;
+      }
+    }
+    ZSTD_freeDStream(stream);
+    *out_read = zout.pos;
+    return err;
+  }
+
+  z_stream strm;
+  memset(&strm, 0, sizeof(strm));
+  if (inflateInit2(&strm, 15 + 32) != Z_OK) {  // gzip or zlib header
+    return common::make_error("inflateInit2 failed");
+  }
+
+  strm.next_in = const_cast<Bytef*>(input);
+  strm.avail_in = std::min(input_size, kMaxInflateInput);
+  strm.next_out = out;
+  strm.avail_out = out_size;
+  const int ret = inflate(&strm, Z_NO_FLUSH);
+  *out_read = out_size - strm.avail_out;
+  common::Error err;
+  if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+    err = common::make_error(strm.msg ? strm.msg : "inflate failed");
+  }
+  inflateEnd(&strm);
+  return err;
+}
+
+FileDecompressor::FileDecompressor(Codec codec, const u_char* input, size_t input_size, size_t headroom)
+    : codec_(codec),
+      input_(input),
+      input_size_(input_size),
+      headroom_(headroom),
+      buffers_(),
+      free_(),
+      ready_(),
+      lock_(),
+      cond_(),
+      finished_(false),
+      stopped_(false),
+      error_(),
+      thread_() {
+  for (size_t i = 0; i < buffers_count; ++i) {
+    std::unique_ptr<Buffer> buffer(new Buffer);
+    buffer->data.resize(headroom_ + buffer_size);
+    buffer->size = 0;
+    free_.push_back(buffer.get());
+    buffers_.push_back(std::move(buffer));
+  }
+}
+
+FileDecompressor::~FileDecompressor() {
+  Stop();
+}
+
+void FileDecompressor::Start() {
+  DCHECK(!thread_.joinable());
+  thread_ = std::thread(&FileDecompressor::Decompress, this);
+}
+
+void FileDecompressor::Stop() {
+  {
+    std::unique_lock<std::mutex> lock(lock_);
+    stopped_ = true;
+  }
+  cond_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+FileDecompressor::Buffer* FileDecompressor::Pop() {
+  std::unique_lock<std::mutex> lock(lock_);
+  cond_.wait(lock, [this]() { return !ready_.empty() || finished_ || stopped_; });
+  if (ready_.empty() || stopped_) {
+    return NULL;
+  }
+
+  Buffer* buffer = ready_.front();
+  ready_.pop_front();
+  return buffer;
+}
+
+void FileDecompressor::Release(Buffer* buffer) {
+  buffer->size = 0;
+  {
+    std::unique_lock<std::mutex> lock(lock_);
+    free_.push_back(buffer);
+  }
+  cond_.notify_all();
+}
+
+common::Error FileDecompressor::GetError() {
+  std::unique_lock<std::mutex> lock(lock_);
+  return error_;
+}
+
+size_t FileDecompressor::GetHeadroom() const {
+  return headroom_;
+}
+
+void FileDecompressor::Decompress() {
+  common::Error err = codec_ == ZSTD_CODEC ? DecompressZstd() : Inflate();
+  {
+    std::unique_lock<std::mutex> lock(lock_);
+    error_ = err;
+    finished_ = true;
+  }
+  cond_.notify_all();
+}
+
+common::Error FileDecompressor::Inflate() {
+  z_stream strm;
+  memset(&strm, 0, sizeof(strm));
+  if (inflateInit2(&strm, 15 + 32) != Z_OK) {  // gzip or zlib header
+    return common::make_error("inflateInit2 failed");
+  }
+
+  Buffer* buffer = AcquireFree();
+  size_t consumed = 0;
+  common::Error err;
+  while (buffer) {
+    if (strm.avail_in == 0 && consumed < input_size_) {
+      const size_t chunk = std::min(input_size_ - consumed, kMaxInflateInput);
+      strm.next_in = const_cast<Bytef*>(input_ + consumed);
+      strm.avail_in = chunk;
+      consumed += chunk;
+    }
+
+    u_char* payload = buffer->data.data() + headroom_;
+    strm.next_out = payload + buffer->size;
+    strm.avail_out = buffer_size - buffer->size;
+    int ret = inflate(&strm, Z_NO_FLUSH);
+    buffer->size = buffer_size - strm.avail_out;
+    if (ret == Z_STREAM_END) {
+      if (strm.avail_in == 0 && consumed == input_size_) {
+        break;
+      }
+      inflateReset(&strm);  // concatenated gzip members
+    } else if (ret == Z_BUF_ERROR && strm.avail_in == 0 && consumed == input_size_) {
+      err = common::make_error("Truncated gzip stream");
+      break;
+    } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+      err = common::make_error(strm.msg ? strm.msg : "inflate failed");
+      break;
+    }
+
+    if (buffer->size == buffer_size) {
+      PushReady(buffer);
+      buffer = AcquireFree();
+    }
+  }
+
+  if (buffer) {
+    if (buffer->size) {
+      PushReady(buffer);
+    } else {
+      Release(buffer);
+    }
+  }
+  inflateEnd(&strm);
+  return err;
+}
+
+common::Error FileDecompressor::DecompressZstd() {
+  ZSTD_DStream* stream = ZSTD_createDStream();
+  if (!stream) {
+    return common::make_error("ZSTD_createDStream failed");
+  }
+  ZSTD_initDStream(stream);
+
+  ZSTD_inBuffer in = {input_, input_size_, 0};
+  Buffer* buffer = AcquireFree();
+  size_t hint = 0;
+  common::Error err;
+  while (buffer) {
+    ZSTD_outBuffer out = {buffer->data.data() + headroom_, buffer_size, buffer->size};
+    hint = ZSTD_decompressStream(stream, &out, &in);
+    if (ZSTD_isError(hint)) {
+      err = common::make_error(ZSTD_getErrorName(hint));
+      break;
+    }
+
+    buffer->size = out.pos;
+    const bool full = out.pos == out.size;
+    if (full) {
+      PushReady(buffer);
+      buffer = AcquireFree();
+    } else if (in.pos == in.size) {
+      if (hint != 0) {  // frame not finished
+        err = common::make_error("Truncated zstd stream");
+      }
+      break;
+    }
+  }
+
+  if (buffer) {
+    if (buffer->size) {
+      PushReady(buffer);
+    } else {
+      Release(buffer);
+    }
+  }
+  ZSTD_freeDStream(stream);
+  return err;
+}
+
+FileDecompressor::Buffer* FileDecompressor::AcquireFree() {
+  std::unique_lock<std::mutex> lock(lock_);
+  cond_.wait(lock, [this]() { return !free_.empty() || stopped_; });
+  if (stopped_) {
+    return NULL;
+  }
+
+  Buffer* buffer = free_.front();
+  free_.pop_front();
+  return buffer;
+}
+
+void FileDecompressor::PushReady(Buffer* buffer) {
+  {
+    std::unique_lock<std::mutex> lock(lock_);
+    ready_.push_back(buffer);
+  }
+  cond_.notify_all();
+}
+}
+}
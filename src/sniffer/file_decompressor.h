@@ -0,0 +1,92 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <common/error.h>
+
+#include "sniffer/packet.h"
+
+namespace sniffer {
+namespace sniffer {
+
+// inflates gzip or zstd compressed file on own thread into bounded queue of reusable buffers
+class FileDecompressor {
+ public:
+  enum Codec { NO_CODEC = 0, GZIP_CODEC, ZSTD_CODEC };
+  enum { buffer_size = 1 << 22, buffers_count = 4 };
+
+  struct Buffer {
+    std::vector<u_char> data;  // headroom followed by payload
+    size_t size;               // payload bytes
+  };
+
+  static Codec DetectCodec(const u_char* data, size_t size);
+  // inflates only beginning of input into out on calling thread, for file header before Start
+  static common::Error Peek(Codec codec,
+                            const u_char* input,
+                            size_t input_size,
+                            u_char* out,
+                            size_t out_size,
+                            size_t* out_read) WARN_UNUSED_RESULT;
+
+  // input must stay valid until Stop, headroom is reserved in front of every payload for caller
+  FileDecompressor(Codec codec, const u_char* input, size_t input_size, size_t headroom);
+  ~FileDecompressor();
+
+  void Start();
+  void Stop();
+
+  // blocks until next buffer, NULL at end of stream, on error or after Stop
+  Buffer* Pop();
+  void Release(Buffer* buffer);
+
+  common::Error GetError();  // valid after Pop returned NULL
+  size_t GetHeadroom() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(FileDecompressor);
+
+  void Decompress();
+  common::Error Inflate() WARN_UNUSED_RESULT;
+  common::Error DecompressZstd() WARN_UNUSED_RESULT;
+
+  Buffer* AcquireFree();  // blocks, NULL after Stop
+  void PushReady(Buffer* buffer);
+
+  const Codec codec_;
+  const u_char* input_;
+  const size_t input_size_;
+  const size_t headroom_;
+
+  std::vector<std::unique_ptr<Buffer>> buffers_;
+  std::deque<Buffer*> free_;
+  std::deque<Buffer*> ready_;
+  std::mutex lock_;
+  std::condition_variable cond_;
+  bool finished_;
+  bool stopped_;
+  common::Error error_;
+  std::thread thread_;
+};
+}
+}
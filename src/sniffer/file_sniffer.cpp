@@ -14,13 +14,35 @@
 
 #include "sniffer/file_sniffer.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
 #include <common/sprintf.h>
 
 namespace sniffer {
 namespace sniffer {
 
 FileSniffer::FileSniffer(const path_type& file_path, ISnifferObserver* observer)
-    : base_class(observer), file_path_(file_path), stopped_(false) {}
+    : base_class(observer),
+      file_path_(file_path),
+      fd_(INVALID_DESCRIPTOR),
+      data_(NULL),
+      size_(0),
+      begin_(0),
+      end_(0),
+      released_(0),
+      codec_(FileDecompressor::NO_CODEC),
+      reader_(),
+      packets_(),
+      link_type_(-1),
+      stopped_(false) {
+  packets_.reserve(max_batch_size);
+}
 
 FileSniffer::~FileSniffer() {}
 
@@ -30,33 +52,105 @@ common::Error FileSniffer::Open() {
     return common::make_error_inval();
   }
 
-  char errbuf[PCAP_ERRBUF_SIZE];
-  /*const char* device = pcap_lookupdev(errbuf);
-  if (device == NULL) {
-    return common::make_error(common::MemSPrintf("Couldn't find default device: %s", errbuf));
-  }*/
-
   std::string path = file_path_.GetPath();
-  pcap_t* pcap = pcap_open_offline_with_tstamp_precision(path.c_str(), PCAP_TSTAMP_PRECISION_MICRO, errbuf);
-  if (!pcap) {
-    return common::make_error(common::MemSPrintf("error reading pcap file: %s", errbuf));
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == INVALID_DESCRIPTOR) {
+    return common::make_error(common::MemSPrintf("error opening pcap file: %s, errno: %d", path.c_str(), errno));
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return common::make_error(common::MemSPrintf("error reading pcap file: %s, empty or unreadable", path.c_str()));
   }
 
-  pcap_ = pcap;
+  const size_t size = st.st_size;
+  void* data = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    close(fd);
+    return common::make_error(common::MemSPrintf("error mapping pcap file: %s, errno: %d", path.c_str(), errno));
+  }
+  madvise(data, size, MADV_SEQUENTIAL);
+
+  const FileDecompressor::Codec codec = FileDecompressor::DetectCodec(static_cast<const u_char*>(data), size);
+  int link_type = -1;
+  if (codec == FileDecompressor::NO_CODEC) {
+    common::Error err = reader_.Init(static_cast<const u_char*>(data), size);
+    if (err) {
+      munmap(data, size);
+      close(fd);
+      return err;
+    }
+    link_type = reader_.GetLinkType();
+  } else {
+    // decoder is bound from peeked header, Run inflates stream from start again
+    std::vector<u_char> header(header_peek_size);
+    size_t header_size = 0;
+    common::Error err = FileDecompressor::Peek(codec, static_cast<const u_char*>(data), size, header.data(),
+                                               header.size(), &header_size);
+    PcapReader probe;
+    if (!err) {
+      err = probe.Init(header.data(), header_size);
+    }
+    if (err) {
+      munmap(data, size);
+      close(fd);
+      return err;
+    }
+    link_type = probe.GetLinkType();
+  }
+
+  fd_ = fd;
+  data_ = static_cast<u_char*>(data);
+  size_ = size;
+  begin_ = 0;
+  end_ = size;
+  released_ = 0;
+  codec_ = codec;
+  // pcapng with interface block beyond view binds decoder in Run, when block is read
+  link_type_ = link_type;
+  BindDecoder(link_type_);
   return common::Error();
 }
 
+common::Error FileSniffer::Close() {
+  common::Error err = base_class::Close();
+  if (data_) {
+    munmap(data_, size_);
+    data_ = NULL;
+  }
+  if (fd_ != INVALID_DESCRIPTOR) {
+    close(fd_);
+    fd_ = INVALID_DESCRIPTOR;
+  }
+  size_ = 0;
+  begin_ = 0;
+  end_ = 0;
+  released_ = 0;
+  codec_ = FileDecompressor::NO_CODEC;
+  packets_.clear();
+  return err;
+}
+
 void FileSniffer::Run() {
   DCHECK(IsValid());
 
-  struct pcap_pkthdr header;
-  const u_char* packet;
-  while ((packet = pcap_next(pcap_, &header)) != NULL) {
-    HandlePacket(packet, &header);
+  if (codec_ != FileDecompressor::NO_CODEC) {
+    RunCompressed();
+    return;
+  }
 
-    if (stopped_) {
-      break;
-    }
+  PcapReader::ReadResult res = ReadPackets();
+  if (stopped_) {
+    return;
+  }
+
+  if (res == PcapReader::READ_INVALID) {
+    ERROR_LOG() << "Reading the packets error: invalid record at offset " << begin_ + reader_.GetOffset()
+                << ", file: " << file_path_.GetPath();
+  } else if (begin_ + reader_.GetOffset() != end_) {
+    WARNING_LOG() << "Truncated record at offset " << begin_ + reader_.GetOffset()
+                  << ", file: " << file_path_.GetPath();
   }
 }
 
@@ -64,8 +158,197 @@ void FileSniffer::Stop() {
   stopped_ = true;
 }
 
+bool FileSniffer::IsValid() const {
+  return data_ != NULL;
+}
+
+int FileSniffer::GetLinkHeaderType() const {
+  return link_type_;
+}
+
 FileSniffer::path_type FileSniffer::GetPath() const {
   return file_path_;
 }
+
+size_t FileSniffer::GetFileSize() const {
+  return size_;
+}
+
+size_t FileSniffer::GetHeaderSize() const {
+  return reader_.GetHeaderSize();
+}
+
+bool FileSniffer::IsPcapng() const {
+  return reader_.IsPcapng();
+}
+
+bool FileSniffer::IsCompressed() const {
+  return codec_ != FileDecompressor::NO_CODEC;
+}
+
+common::Error FileSniffer::SetRange(size_t begin, size_t end) {
+  DCHECK(IsValid());
+  if (IsCompressed() || reader_.IsPcapng() || begin < reader_.GetHeaderSize() || begin > end || end > size_) {
+    return common::make_error_inval();
+  }
+
+  reader_.SetData(data_ + begin, end - begin);
+  begin_ = begin;
+  end_ = end;
+  const size_t page_size = getpagesize();
+  released_ = begin / page_size * page_size;
+  return common::Error();
+}
+
+bool FileSniffer::FindRecordBoundary(size_t from, size_t* offset) const {
+  DCHECK(IsValid());
+  if (IsCompressed() || reader_.IsPcapng() || !offset) {
+    return false;
+  }
+
+  // record headers carry no magic, accept position only if following headers chain up to it
+  const size_t start = std::max(from, reader_.GetHeaderSize());
+  const size_t stop = std::min(size_, start + boundary_scan_limit);
+  for (size_t pos = start; pos < stop; ++pos) {
+    size_t cur = pos;
+    bool valid = true;
+    for (size_t i = 0; i < boundary_chain_length && cur != size_; ++i) {
+      size_t record_size = 0;
+      if (!reader_.PeekRecord(data_ + cur, size_ - cur, &record_size) || record_size > size_ - cur) {
+        valid = false;
+        break;
+      }
+      cur += record_size;
+    }
+
+    if (valid) {
+      *offset = pos;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+PcapReader::ReadResult FileSniffer::ReadPackets() {
+  Packet packet;
+  PcapReader::ReadResult res = PcapReader::READ_OK;
+  while (!stopped_ && (res = reader_.Next(&packet)) == PcapReader::READ_OK) {
+    // one batch holds packets of one link type, pcapng interfaces may differ
+    if (!packets_.empty() && reader_.GetLinkType() != link_type_) {
+      DeliverPackets();
+    }
+
+    if (reader_.GetLinkType() != link_type_) {
+      link_type_ = reader_.GetLinkType();
+      BindDecoder(link_type_);
+    }
+    packets_.push_back(packet);
+    if (packets_.size() == max_batch_size) {
+      DeliverPackets();
+      if (codec_ == FileDecompressor::NO_CODEC) {
+        ReleaseConsumed(begin_ + reader_.GetOffset());
+      }
+    }
+  }
+  DeliverPackets();
+  return res;
+}
+
+void FileSniffer::RunCompressed() {
+  FileDecompressor decompressor(codec_, data_, size_, stream_headroom);
+  decompressor.Start();
+
+  // record cut by end of buffer is copied into headroom of next one, so reader always sees it contiguous
+  FileDecompressor::Buffer* current = NULL;
+  const u_char* tail = NULL;
+  size_t tail_size = 0;
+  uint64_t stream_offset = 0;  // inflated bytes before reader view
+  bool initialized = false;
+  PcapReader::ReadResult res = PcapReader::READ_NEED_MORE;
+  while (!stopped_) {
+    FileDecompressor::Buffer* next = decompressor.Pop();
+    if (!next) {
+      break;
+    }
+
+    u_char* view = next->data.data() + stream_headroom - tail_size;
+    memcpy(view, tail, tail_size);
+    const size_t view_size = tail_size + next->size;
+    if (current) {
+      decompressor.Release(current);
+    }
+    current = next;
+
+    if (!initialized) {
+      common::Error err = reader_.Init(view, view_size);
+      if (err) {
+        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+        tail_size = 0;
+        break;
+      }
+      initialized = true;
+    } else {
+      reader_.SetData(view, view_size);
+    }
+
+    res = ReadPackets();
+    if (res == PcapReader::READ_INVALID) {
+      ERROR_LOG() << "Reading the packets error: invalid record at inflated offset " << stream_offset + reader_.GetOffset()
+                  << ", file: " << file_path_.GetPath();
+      break;
+    }
+
+    stream_offset += reader_.GetOffset();
+    tail = view + reader_.GetOffset();
+    tail_size = view_size - reader_.GetOffset();
+    if (tail_size > stream_headroom) {
+      ERROR_LOG() << "Reading the packets error: record larger than " << stream_headroom
+                  << " bytes at inflated offset " << stream_offset << ", file: " << file_path_.GetPath();
+      break;
+    }
+  }
+
+  if (current) {
+    decompressor.Release(current);
+  }
+  decompressor.Stop();
+  if (stopped_ || res == PcapReader::READ_INVALID) {
+    return;
+  }
+
+  common::Error err = decompressor.GetError();
+  if (err) {
+    ERROR_LOG() << "Decompressing error: " << err->GetDescription() << ", file: " << file_path_.GetPath();
+  } else if (tail_size != 0) {
+    WARNING_LOG() << "Truncated record at inflated offset " << stream_offset << ", file: " << file_path_.GetPath();
+  }
+}
+
+bool FileSniffer::IsStopped() const {
+  return stopped_;
+}
+
+void FileSniffer::DeliverBatch(const Packet* packets, size_t count) {
+  HandlePackets(packets, count);
+}
+
+void FileSniffer::DeliverPackets() {
+  DeliverBatch(packets_.data(), packets_.size());
+  packets_.clear();
+}
+
+void FileSniffer::ReleaseConsumed(size_t offset) {
+  // nothing refers to delivered packets anymore, drop them from process and page cache
+  const size_t page_size = getpagesize();
+  const size_t end = offset / page_size * page_size;
+  if (end < released_ + release_chunk_size) {
+    return;
+  }
+
+  madvise(data_ + released_, end - released_, MADV_DONTNEED);
+  posix_fadvise(fd_, released_, end - released_, POSIX_FADV_DONTNEED);
+  released_ = end;
+}
 }
 }
@@ -14,34 +14,79 @@
 
 #pragma once
 
+#include <atomic>
+
 #include <common/file_system/path.h>
 
+#include "sniffer/file_decompressor.h"
 #include "sniffer/isniffer.h"
+#include "sniffer/pcap_reader.h"
 
 namespace sniffer {
 namespace sniffer {
 
+// reads pcap and pcapng files through read-only mapping, packets are delivered in place,
+// gzip and zstd compressed files are inflated on a separate thread and streamed
 class FileSniffer : public ISniffer {
  public:
   typedef ISniffer base_class;
   typedef common::file_system::ascii_file_string_path path_type;
+  enum {
+    release_chunk_size = 1 << 25,  // consumed pages are dropped by this step
+    boundary_chain_length = 8,     // record headers validated in a row to accept boundary
+    boundary_scan_limit = 1 << 24, // bytes scanned for boundary before giving up
+    stream_headroom = 1 << 19,     // largest record split between decompressed buffers
+    header_peek_size = 1 << 16     // inflated at Open for link type of compressed file
+  };
 
   FileSniffer(const path_type& file_path, ISnifferObserver* observer);
   ~FileSniffer();
 
   virtual common::Error Open() override WARN_UNUSED_RESULT;
+  virtual common::Error Close() override WARN_UNUSED_RESULT;
 
   void Run() override;
   void Stop() override;
 
+  virtual bool IsValid() const override;
+  virtual int GetLinkHeaderType() const override;
+
   path_type GetPath() const;
+  size_t GetFileSize() const;
+  size_t GetHeaderSize() const;
+  bool IsPcapng() const;
+  bool IsCompressed() const;
 
- private:
-  static void pcap_handler(u_char* packet, const struct pcap_pkthdr* header, const u_char* user_data);
+  // classic pcap only, call after Open, Run reads records in [begin, end) of file
+  common::Error SetRange(size_t begin, size_t end) WARN_UNUSED_RESULT;
+  // classic pcap only, first offset from which a chain of record headers validates
+  bool FindRecordBoundary(size_t from, size_t* offset) const;
+
+ protected:
+  bool IsStopped() const;
+  // called from Run for every batch read from file
+  virtual void DeliverBatch(const Packet* packets, size_t count);
 
+ private:
   DISALLOW_COPY_AND_ASSIGN(FileSniffer);
+
+  PcapReader::ReadResult ReadPackets();
+  void RunCompressed();
+  void DeliverPackets();
+  void ReleaseConsumed(size_t offset);
+
   path_type file_path_;
-  volatile bool stopped_;
+  int fd_;
+  u_char* data_;
+  size_t size_;
+  size_t begin_;  // file offset of reader view
+  size_t end_;
+  size_t released_;
+  FileDecompressor::Codec codec_;
+  PcapReader reader_;
+  std::vector<Packet> packets_;
+  int link_type_;  // of packets_
+  std::atomic<bool> stopped_;
 };
 }
 }
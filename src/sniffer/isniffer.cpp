@@ -16,10 +16,14 @@
 
 #include "isniffer_observer.h"
 
+#include "utils.h"
+
 namespace sniffer {
 namespace sniffer {
 
-ISniffer::ISniffer(ISnifferObserver* observer) : pcap_(NULL), pos_(0), observer_(observer) {}
+CaptureStats::CaptureStats() : received(0), dropped(0), if_dropped(0) {}
+
+ISniffer::ISniffer(ISnifferObserver* observer) : pcap_(NULL), pos_(0), observer_(observer), decoder_(NULL) {}
 
 ISniffer::~ISniffer() {}
 
@@ -30,6 +34,7 @@ common::Error ISniffer::Close() {
   }
   pcap_ = NULL;
   pos_ = 0;
+  decoder_ = NULL;
   return common::Error();
 }
 
@@ -52,11 +57,67 @@ void ISniffer::HandlePacket(const u_char* packet, const struct pcap_pkthdr* head
   pos_++;
 }
 
+void ISniffer::HandlePackets(const Packet* packets, size_t count) {
+  if (count == 0) {
+    return;
+  }
+
+  if (observer_) {
+    observer_->HandlePackets(this, packets, count);
+  }
+  pos_ += count;
+}
+
+void ISniffer::HandleBatch(PacketBatch* batch) {
+  if (batch->IsEmpty()) {
+    return;
+  }
+
+  HandlePackets(batch->GetPackets(), batch->GetSize());
+  batch->Clear();
+}
+
 int ISniffer::GetLinkHeaderType() const {
   // DLT_PRISM_HEADER
   // DLT_IEEE802_11_RADIO
   // https://github.com/sidak/WiFi-Sniffing-and-Distributed-Computing/blob/master/Wifi%20Computing/packetspammer.c
   return pcap_datalink(pcap_);
 }
+
+const LinkDecoder* ISniffer::GetDecoder() const {
+  return decoder_;
+}
+
+void ISniffer::BindDecoder(int link_type) {
+  decoder_ = FindLinkDecoder(link_type);
+}
+
+std::string ISniffer::GetDevice() const {
+  return std::string();
+}
+
+common::Error ISniffer::SetFilter(const std::string& expression) {
+  if (!pcap_) {
+    return common::make_error_inval();
+  }
+
+  struct bpf_program program;
+  if (pcap_compile(pcap_, &program, expression.c_str(), 1, PCAP_NETMASK_UNKNOWN) == -1) {
+    return common::make_error(pcap_geterr(pcap_));
+  }
+
+  int res = pcap_setfilter(pcap_, &program);
+  pcap_freecode(&program);
+  if (res == -1) {
+    return common::make_error(pcap_geterr(pcap_));
+  }
+
+  return common::Error();
+}
+
+common::Error ISniffer::GetStats(CaptureStats* stats) {
+  UNUSED(stats);
+  return common::make_error("Statistics not supported");
+}
 }
 }
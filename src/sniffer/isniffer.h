@@ -16,14 +16,28 @@
 
 #include <pcap.h>
 
+#include <string>
+
 #include <common/error.h>
 
+#include "sniffer/packet.h"
+
 namespace sniffer {
+struct LinkDecoder;
 namespace sniffer {
 class ISnifferObserver;
 
+struct CaptureStats {
+  CaptureStats();
+
+  uint64_t received;    // packets seen by the kernel
+  uint64_t dropped;     // packets dropped by the kernel, buffer or ring was full
+  uint64_t if_dropped;  // packets dropped by the interface or its driver
+};
+
 class ISniffer {
  public:
+  enum { max_batch_size = 256 };
   ISniffer(ISnifferObserver* observer);
   virtual ~ISniffer();
 
@@ -35,20 +49,34 @@ class ISniffer {
 
   size_t GetCurrentPos() const;
 
-  bool IsValid() const;
+  virtual bool IsValid() const;
   bool IsOpen() const;
 
-    int GetLinkHeaderType() const;
+  virtual int GetLinkHeaderType() const;
+  virtual std::string GetDevice() const;  // capture interface, empty for files
+
+  // entry parser of link type bound when Open succeeds, NULL if link type is not supported
+  const LinkDecoder* GetDecoder() const;
+
+  // installs BPF program, call after Open, empty expression accepts everything
+  virtual common::Error SetFilter(const std::string& expression) WARN_UNUSED_RESULT;
+
+  // cumulative since Open, called only from one thread
+  virtual common::Error GetStats(CaptureStats* stats) WARN_UNUSED_RESULT;
 
  protected:
   pcap_t* pcap_;
   void HandlePacket(const u_char* packet, const struct pcap_pkthdr* header);
+  void HandlePackets(const Packet* packets, size_t count);
+  void HandleBatch(PacketBatch* batch);  // delivers and clears
+  void BindDecoder(int link_type);
 
  private:
   DISALLOW_COPY_AND_ASSIGN(ISniffer);
 
   size_t pos_;
   ISnifferObserver* observer_;
+  const LinkDecoder* decoder_;
 };
 }
 }
@@ -15,5 +15,12 @@
 #include "isniffer_observer.h"
 
 namespace sniffer {
-namespace sniffer {}
+namespace sniffer {
+
+void ISnifferObserver::HandlePackets(ISniffer* sniffer, const Packet* packets, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    HandlePacket(sniffer, packets[i].data, &packets[i].header);
+  }
+}
+}
 }
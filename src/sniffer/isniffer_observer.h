@@ -16,7 +16,7 @@
 
 #include <common/error.h>
 
-struct pcap_pkthdr;
+#include "sniffer/packet.h"
 
 namespace sniffer {
 namespace sniffer {
@@ -25,6 +25,8 @@ class ISniffer;
 class ISnifferObserver {
  public:
   virtual void HandlePacket(ISniffer* sniffer, const u_char* packet, const struct pcap_pkthdr* header) = 0;
+  // sniffers deliver packets in batches, default adapter passes them one by one to HandlePacket
+  virtual void HandlePackets(ISniffer* sniffer, const Packet* packets, size_t count);
 };
 
 }
@@ -14,18 +14,60 @@
 
 #include "sniffer/live_sniffer.h"
 
+#include <errno.h>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
 #include <linux/if.h>
 #include <netdb.h>
+#include <unistd.h>
 
 #include <common/sprintf.h>
 
 namespace sniffer {
 namespace sniffer {
+namespace {
+// set before pcap_activate, unchecked failure leaves libpcap default in place
+common::Error SetCaptureOption(const char* option, int res) {
+  if (res != 0) {
+    return common::make_error(common::MemSPrintf("can't set capture %s: %s", option, pcap_statustostr(res)));
+  }
+  return common::Error();
+}
+
+common::Error SetCaptureOptions(pcap_t* pcap, const CaptureOptions& options) {
+  common::Error err = SetCaptureOption("snaplen", pcap_set_snaplen(pcap, options.snaplen));
+  if (err) {
+    return err;
+  }
+
+  err = SetCaptureOption("timeout", pcap_set_timeout(pcap, options.read_timeout));
+  if (err) {
+    return err;
+  }
+
+  if (options.buffer_size > 0) {
+    err = SetCaptureOption("buffer size", pcap_set_buffer_size(pcap, options.buffer_size));
+    if (err) {
+      return err;
+    }
+  }
+
+  if (options.immediate) {
+    return SetCaptureOption("immediate mode", pcap_set_immediate_mode(pcap, 1));
+  }
+  return common::Error();
+}
+}  // namespace
+
+CaptureOptions::CaptureOptions() : snaplen(BUFSIZ), buffer_size(0), read_timeout(1000), immediate(false), busy_poll(0) {}
 
-LiveSniffer::LiveSniffer(const std::string& device, ISnifferObserver* observer, int read_timeout)
-    : base_class(observer), device_(device), mac_{0}, read_timeout_(read_timeout), stopped_(false) {}
+LiveSniffer::LiveSniffer(const std::string& device, ISnifferObserver* observer, const CaptureOptions& options)
+    : base_class(observer),
+      batch_(max_batch_size),
+      device_(device),
+      mac_{0},
+      options_(options),
+      stopped_(false) {}
 
 LiveSniffer::~LiveSniffer() {}
 
@@ -37,9 +79,31 @@ common::Error LiveSniffer::Open() {
 
   const char* device_str = device_.c_str();
   char errbuf[PCAP_ERRBUF_SIZE];
-  pcap_t* pcap = pcap_open_live(device_str, BUFSIZ, PCAP_TSTAMP_PRECISION_MICRO, read_timeout_, errbuf);
+  pcap_t* pcap = pcap_create(device_str, errbuf);
   if (!pcap) {
-    return common::make_error(common::MemSPrintf("error reading pcap file: %s", errbuf));
+    return common::make_error(common::MemSPrintf("error opening device: %s", errbuf));
+  }
+
+  common::Error err = SetCaptureOptions(pcap, options_);
+  if (err) {
+    pcap_close(pcap);
+    return err;
+  }
+
+  int res = pcap_activate(pcap);
+  if (res < 0) {
+    err = common::make_error(common::MemSPrintf("error activating device: %s", pcap_geterr(pcap)));
+    pcap_close(pcap);
+    return err;
+  } else if (res > 0) {
+    WARNING_LOG() << "Activating device warning: " << pcap_geterr(pcap);
+  }
+
+  if (options_.busy_poll > 0) {
+    int usec = options_.busy_poll;
+    if (setsockopt(pcap_get_selectable_fd(pcap), SOL_SOCKET, SO_BUSY_POLL, &usec, sizeof(usec)) != 0) {
+      WARNING_LOG() << "Can't enable busy poll on device: " << device_ << ", errno: " << errno;
+    }
   }
 
   struct ifreq s;
@@ -48,21 +112,18 @@ common::Error LiveSniffer::Open() {
   if (ioctl(fd, SIOCGIFHWADDR, &s) == 0) {
     memcpy(mac_, s.ifr_addr.sa_data, sizeof(mac_));
   }
+  close(fd);
   pcap_ = pcap;
+  BindDecoder(pcap_datalink(pcap));
   return common::Error();
 }
 
 void LiveSniffer::Run() {
   DCHECK(IsValid());
 
-  struct pcap_pkthdr* header = NULL;
-  const u_char* packet = NULL;
   int res;
-  while ((res = pcap_next_ex(pcap_, &header, &packet)) >= 0) {
-    if (res == 0) {
-    } else if (res == 1) {
-      HandlePacket(packet, header);
-    }
+  while ((res = pcap_dispatch(pcap_, max_batch_size, pcap_handler, reinterpret_cast<u_char*>(this))) >= 0) {
+    HandleBatch(&batch_);
 
     if (stopped_) {
       break;
@@ -78,9 +139,59 @@ void LiveSniffer::Stop() {
   stopped_ = true;
 }
 
-void LiveSniffer::pcap_handler(u_char* packet, const struct pcap_pkthdr* header, const u_char* user_data) {
-  LiveSniffer* sniffer = (LiveSniffer*)(user_data);
-  sniffer->HandlePacket(packet, header);
+common::Error LiveSniffer::SetNonBlocking(bool non_blocking) {
+  DCHECK(IsValid());
+  char errbuf[PCAP_ERRBUF_SIZE];
+  if (pcap_setnonblock(pcap_, non_blocking, errbuf) == -1) {
+    return common::make_error(common::MemSPrintf("error setting non-blocking mode: %s", errbuf));
+  }
+
+  return common::Error();
+}
+
+descriptor_t LiveSniffer::GetSelectableFd() const {
+  DCHECK(IsValid());
+  return pcap_get_selectable_fd(pcap_);
+}
+
+common::Error LiveSniffer::DispatchPending() {
+  DCHECK(IsValid());
+  for (size_t i = 0; i < max_dispatch_batches; ++i) {
+    int res = pcap_dispatch(pcap_, max_batch_size, pcap_handler, reinterpret_cast<u_char*>(this));
+    if (res == -1) {
+      return common::make_error(common::MemSPrintf("Reading the packets error: %s", pcap_geterr(pcap_)));
+    }
+
+    HandleBatch(&batch_);
+    if (res == 0) {  // nothing buffered anymore
+      break;
+    }
+  }
+
+  return common::Error();
+}
+
+common::Error LiveSniffer::GetStats(CaptureStats* stats) {
+  if (!stats) {
+    return common::make_error_inval();
+  }
+
+  DCHECK(IsValid());
+  struct pcap_stat st;
+  if (pcap_stats(pcap_, &st) != 0) {
+    return common::make_error(pcap_geterr(pcap_));
+  }
+
+  // counters are cumulative since activation, 32 bit on every platform
+  stats->received = st.ps_recv;
+  stats->dropped = st.ps_drop;
+  stats->if_dropped = st.ps_ifdrop;
+  return common::Error();
+}
+
+void LiveSniffer::pcap_handler(u_char* user_data, const struct pcap_pkthdr* header, const u_char* packet) {
+  LiveSniffer* sniffer = reinterpret_cast<LiveSniffer*>(user_data);
+  sniffer->batch_.Add(header, packet);
 }
 
 std::string LiveSniffer::GetDevice() const {
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "types.h"
 
 #include "sniffer/isniffer.h"
@@ -21,10 +23,21 @@
 namespace sniffer {
 namespace sniffer {
 
+struct CaptureOptions {
+  CaptureOptions();
+
+  int snaplen;       // bytes kept from every frame
+  int buffer_size;   // kernel buffer in bytes, 0 - libpcap default
+  int read_timeout;  // msec, not used in immediate mode
+  bool immediate;    // deliver every packet as soon as it arrives
+  int busy_poll;     // SO_BUSY_POLL usec, 0 - disabled
+};
+
 class LiveSniffer : public ISniffer {
  public:
   typedef ISniffer base_class;
-  LiveSniffer(const std::string& device, ISnifferObserver* observer, int read_timeout = 1000);
+  enum { max_dispatch_batches = 64 };  // per readiness event, keeps event loop responsive
+  LiveSniffer(const std::string& device, ISnifferObserver* observer, const CaptureOptions& options = CaptureOptions());
   virtual ~LiveSniffer();
 
   virtual common::Error Open() override WARN_UNUSED_RESULT;
@@ -32,18 +45,27 @@ class LiveSniffer : public ISniffer {
   virtual void Run() override;
   virtual void Stop() override;
 
-  std::string GetDevice() const;
+  virtual common::Error GetStats(CaptureStats* stats) override WARN_UNUSED_RESULT;
+
+  // event driven capture instead of Run, call after Open
+  common::Error SetNonBlocking(bool non_blocking) WARN_UNUSED_RESULT;
+  descriptor_t GetSelectableFd() const;
+  // drains what is buffered in non-blocking mode, delivers packets on caller thread
+  common::Error DispatchPending() WARN_UNUSED_RESULT;
+
+  virtual std::string GetDevice() const override;
 
   const unsigned char* GetRawMacAddress() const;
   std::string GetMacAddress() const;
 
  private:
-  static void pcap_handler(u_char* packet, const struct pcap_pkthdr* header, const u_char* user_data);
+  static void pcap_handler(u_char* user_data, const struct pcap_pkthdr* header, const u_char* packet);
 
+  PacketBatch batch_;
   std::string device_;
   mac_address_t mac_;
-  int read_timeout_;
-  bool stopped_;
+  const CaptureOptions options_;
+  std::atomic<bool> stopped_;
 };
 }
 }
@@ -0,0 +1,62 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "sniffer/packet.h"
+
+namespace sniffer {
+namespace sniffer {
+
+PacketBatch::PacketBatch(size_t capacity) : capacity_(capacity), packets_(), offsets_(), buffer_() {
+  packets_.reserve(capacity);
+  offsets_.reserve(capacity);
+}
+
+void PacketBatch::Add(const struct pcap_pkthdr* header, const u_char* data) {
+  DCHECK(!IsFull());
+  const size_t offset = buffer_.size();
+  buffer_.insert(buffer_.end(), data, data + header->caplen);
+
+  Packet packet;
+  packet.header = *header;
+  packet.data = NULL;
+  packets_.push_back(packet);
+  offsets_.push_back(offset);
+}
+
+const Packet* PacketBatch::GetPackets() {
+  for (size_t i = 0; i < packets_.size(); ++i) {
+    packets_[i].data = buffer_.data() + offsets_[i];
+  }
+  return packets_.data();
+}
+
+size_t PacketBatch::GetSize() const {
+  return packets_.size();
+}
+
+bool PacketBatch::IsEmpty() const {
+  return packets_.empty();
+}
+
+bool PacketBatch::IsFull() const {
+  return packets_.size() >= capacity_;
+}
+
+void PacketBatch::Clear() {
+  packets_.clear();
+  offsets_.clear();
+  buffer_.clear();
+}
+}
+}
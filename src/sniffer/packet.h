@@ -0,0 +1,54 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <pcap.h>
+
+#include <vector>
+
+#include <common/macros.h>
+
+namespace sniffer {
+namespace sniffer {
+
+// view of captured frame, data is owned by the sniffer and valid only inside observer call
+struct Packet {
+  struct pcap_pkthdr header;
+  const u_char* data;
+};
+
+// collects packets from sources which reuse their buffer per packet (pcap_dispatch callbacks)
+class PacketBatch {
+ public:
+  explicit PacketBatch(size_t capacity);
+
+  void Add(const struct pcap_pkthdr* header, const u_char* data);
+
+  const Packet* GetPackets();  // fixes up data pointers, valid until next Add/Clear
+  size_t GetSize() const;
+  bool IsEmpty() const;
+  bool IsFull() const;
+  void Clear();
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(PacketBatch);
+
+  const size_t capacity_;
+  std::vector<Packet> packets_;
+  std::vector<size_t> offsets_;
+  std::vector<u_char> buffer_;
+};
+}
+}
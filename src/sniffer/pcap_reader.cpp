@@ -0,0 +1,377 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "sniffer/pcap_reader.h"
+
+#include <byteswap.h>
+#include <string.h>
+
+#include <algorithm>
+
+namespace sniffer {
+namespace sniffer {
+
+namespace {
+const uint32_t kPcapMagicUsec = 0xa1b2c3d4;
+const uint32_t kPcapMagicNsec = 0xa1b23c4d;
+const size_t kPcapFileHeaderSize = 24;
+const size_t kPcapRecordHeaderSize = 16;
+const uint32_t kMaxSnaplen = 262144;  // libpcap MAXIMUM_SNAPLEN
+
+const uint32_t kBlockSectionHeader = 0x0A0D0D0A;
+const uint32_t kBlockInterface = 0x00000001;
+const uint32_t kBlockSimplePacket = 0x00000003;
+const uint32_t kBlockEnhancedPacket = 0x00000006;
+const uint32_t kByteOrderMagic = 0x1A2B3C4D;
+const size_t kBlockHeaderSize = 8;  // type, total length
+const size_t kBlockMinSize = 12;    // type, total length, trailing total length
+const size_t kSectionHeaderMinSize = 28;
+const size_t kInterfaceMinSize = 20;
+const size_t kEnhancedPacketMinSize = 32;
+const size_t kSimplePacketMinSize = 16;
+
+const uint16_t kOptionEnd = 0;
+const uint16_t kOptionTsResol = 9;
+const uint16_t kOptionTsOffset = 14;
+
+const uint64_t kMicrosecondsPerSecond = 1000000;
+
+size_t align4(size_t len) {
+  return (len + 3) & ~static_cast<size_t>(3);
+}
+
+void make_timeval(uint64_t ts, uint64_t units_per_sec, int64_t ts_offset, struct timeval* tv) {
+  const uint64_t frac = ts % units_per_sec;
+  tv->tv_sec = static_cast<time_t>(ts / units_per_sec + ts_offset);
+  if (units_per_sec >= kMicrosecondsPerSecond) {
+    tv->tv_usec = static_cast<suseconds_t>(frac / (units_per_sec / kMicrosecondsPerSecond));
+  } else {
+    tv->tv_usec = static_cast<suseconds_t>(frac * kMicrosecondsPerSecond / units_per_sec);
+  }
+}
+}  // namespace
+
+PcapReader::PcapReader()
+    : data_(NULL),
+      size_(0),
+      offset_(0),
+      pcapng_(false),
+      swapped_(false),
+      nsec_(false),
+      header_size_(0),
+      snaplen_(0),
+      link_type_(-1),
+      interfaces_() {}
+
+common::Error PcapReader::Init(const u_char* data, size_t size) {
+  if (!data || size < sizeof(uint32_t)) {
+    return common::make_error_inval();
+  }
+
+  data_ = data;
+  size_ = size;
+  offset_ = 0;
+  interfaces_.clear();
+
+  uint32_t magic;
+  memcpy(&magic, data, sizeof(magic));
+  if (magic == kBlockSectionHeader) {
+    pcapng_ = true;
+    if (size < kSectionHeaderMinSize) {
+      return common::make_error("Truncated pcapng section header");
+    }
+
+    uint32_t byte_order;
+    memcpy(&byte_order, data + kBlockHeaderSize, sizeof(byte_order));
+    swapped_ = byte_order != kByteOrderMagic;
+    uint32_t block_len = Read32(data + sizeof(uint32_t));
+    if (block_len > size || !ReadSectionHeader(data, block_len)) {
+      return common::make_error("Invalid pcapng section header");
+    }
+
+    header_size_ = block_len;
+    offset_ = block_len;
+
+    // first interface block gives link type before any packet is read
+    link_type_ = -1;
+    size_t pos = block_len;
+    while (pos + kBlockMinSize <= size) {
+      const uint32_t type = Read32(data + pos);
+      const uint32_t len = Read32(data + pos + sizeof(uint32_t));
+      if (len < kBlockMinSize || len % 4 != 0 || len > size - pos) {
+        break;
+      }
+      if (type == kBlockInterface) {
+        if (len >= kInterfaceMinSize) {
+          link_type_ = Read16(data + pos + kBlockHeaderSize);
+        }
+        break;
+      }
+      if (type == kBlockSectionHeader || type == kBlockEnhancedPacket || type == kBlockSimplePacket) {
+        break;
+      }
+      pos += len;
+    }
+    return common::Error();
+  }
+
+  pcapng_ = false;
+  if (magic == kPcapMagicUsec || magic == kPcapMagicNsec) {
+    swapped_ = false;
+  } else if (magic == bswap_32(kPcapMagicUsec) || magic == bswap_32(kPcapMagicNsec)) {
+    swapped_ = true;
+  } else {
+    return common::make_error("Unknown capture file format");
+  }
+
+  if (size < kPcapFileHeaderSize) {
+    return common::make_error("Truncated pcap file header");
+  }
+
+  nsec_ = Read32(data) == kPcapMagicNsec;
+  snaplen_ = Read32(data + 16);
+  link_type_ = Read32(data + 20) & 0xFFFF;  // upper bits carry FCS length
+  header_size_ = kPcapFileHeaderSize;
+  offset_ = kPcapFileHeaderSize;
+  return common::Error();
+}
+
+void PcapReader::SetData(const u_char* data, size_t size) {
+  data_ = data;
+  size_ = size;
+  offset_ = 0;
+}
+
+PcapReader::ReadResult PcapReader::Next(Packet* packet) {
+  DCHECK(data_);
+  return pcapng_ ? NextPcapng(packet) : NextPcap(packet);
+}
+
+size_t PcapReader::GetOffset() const {
+  return offset_;
+}
+
+size_t PcapReader::GetHeaderSize() const {
+  return header_size_;
+}
+
+int PcapReader::GetLinkType() const {
+  return link_type_;
+}
+
+bool PcapReader::IsPcapng() const {
+  return pcapng_;
+}
+
+bool PcapReader::PeekRecord(const u_char* data, size_t size, size_t* record_size) const {
+  DCHECK(!pcapng_);
+  if (size < kPcapRecordHeaderSize) {
+    return false;
+  }
+
+  const uint32_t ts_frac = Read32(data + 4);
+  const uint32_t caplen = Read32(data + 8);
+  const uint32_t len = Read32(data + 12);
+  if (ts_frac >= (nsec_ ? 1000000000 : 1000000)) {
+    return false;
+  }
+  if (caplen > kMaxSnaplen || caplen > len || (snaplen_ && caplen > snaplen_)) {
+    return false;
+  }
+
+  *record_size = kPcapRecordHeaderSize + caplen;
+  return true;
+}
+
+uint16_t PcapReader::Read16(const u_char* data) const {
+  uint16_t val;
+  memcpy(&val, data, sizeof(val));
+  return swapped_ ? bswap_16(val) : val;
+}
+
+uint32_t PcapReader::Read32(const u_char* data) const {
+  uint32_t val;
+  memcpy(&val, data, sizeof(val));
+  return swapped_ ? bswap_32(val) : val;
+}
+
+PcapReader::ReadResult PcapReader::NextPcap(Packet* packet) {
+  const u_char* record = data_ + offset_;
+  const size_t rest = size_ - offset_;
+  if (rest < kPcapRecordHeaderSize) {
+    return READ_NEED_MORE;
+  }
+
+  const uint32_t caplen = Read32(record + 8);
+  if (caplen > kMaxSnaplen) {
+    return READ_INVALID;
+  }
+  if (rest < kPcapRecordHeaderSize + caplen) {
+    return READ_NEED_MORE;
+  }
+
+  const uint32_t ts_frac = Read32(record + 4);
+  packet->header.ts.tv_sec = Read32(record);
+  packet->header.ts.tv_usec = nsec_ ? ts_frac / 1000 : ts_frac;
+  packet->header.caplen = caplen;
+  packet->header.len = Read32(record + 12);
+  packet->data = record + kPcapRecordHeaderSize;
+  offset_ += kPcapRecordHeaderSize + caplen;
+  return READ_OK;
+}
+
+PcapReader::ReadResult PcapReader::NextPcapng(Packet* packet) {
+  while (true) {
+    const u_char* block = data_ + offset_;
+    const size_t rest = size_ - offset_;
+    if (rest < kBlockMinSize) {
+      return READ_NEED_MORE;
+    }
+
+    uint32_t block_type;
+    memcpy(&block_type, block, sizeof(block_type));
+    if (block_type == kBlockSectionHeader) {
+      // new section may change byte order
+      uint32_t byte_order;
+      memcpy(&byte_order, block + kBlockHeaderSize, sizeof(byte_order));
+      swapped_ = byte_order != kByteOrderMagic;
+    } else {
+      block_type = Read32(block);
+    }
+
+    const uint32_t block_len = Read32(block + sizeof(uint32_t));
+    if (block_len < kBlockMinSize || block_len % 4 != 0) {
+      return READ_INVALID;
+    }
+    if (rest < block_len) {
+      return READ_NEED_MORE;
+    }
+    offset_ += block_len;
+
+    if (block_type == kBlockSectionHeader) {
+      if (!ReadSectionHeader(block, block_len)) {
+        return READ_INVALID;
+      }
+    } else if (block_type == kBlockInterface) {
+      if (!ReadInterface(block, block_len)) {
+        return READ_INVALID;
+      }
+    } else if (block_type == kBlockEnhancedPacket) {
+      if (block_len < kEnhancedPacketMinSize) {
+        return READ_INVALID;
+      }
+
+      const uint32_t iface = Read32(block + 8);
+      const uint32_t caplen = Read32(block + 20);
+      if (iface >= interfaces_.size() || align4(caplen) > block_len - kEnhancedPacketMinSize) {
+        return READ_INVALID;
+      }
+
+      const Interface& inf = interfaces_[iface];
+      const uint64_t ts = (static_cast<uint64_t>(Read32(block + 12)) << 32) | Read32(block + 16);
+      make_timeval(ts, inf.units_per_sec, inf.ts_offset, &packet->header.ts);
+      packet->header.caplen = caplen;
+      packet->header.len = Read32(block + 24);
+      packet->data = block + 28;
+      link_type_ = inf.link_type;
+      return READ_OK;
+    } else if (block_type == kBlockSimplePacket) {
+      if (block_len < kSimplePacketMinSize || interfaces_.empty()) {
+        return READ_INVALID;
+      }
+
+      const Interface& inf = interfaces_[0];
+      const uint32_t len = Read32(block + 8);
+      uint32_t caplen = std::min<uint32_t>(len, block_len - kSimplePacketMinSize);
+      if (inf.snaplen) {
+        caplen = std::min(caplen, inf.snaplen);
+      }
+      // no timestamp in simple packet block
+      packet->header.ts.tv_sec = 0;
+      packet->header.ts.tv_usec = 0;
+      packet->header.caplen = caplen;
+      packet->header.len = len;
+      packet->data = block + 12;
+      link_type_ = inf.link_type;
+      return READ_OK;
+    }
+    // other blocks (statistics, name resolution, custom) are skipped
+  }
+}
+
+bool PcapReader::ReadSectionHeader(const u_char* block, uint32_t block_len) {
+  if (block_len < kSectionHeaderMinSize || Read16(block + 12) != 1) {  // major version
+    return false;
+  }
+
+  interfaces_.clear();  // interface ids are local to section
+  return true;
+}
+
+bool PcapReader::ReadInterface(const u_char* block, uint32_t block_len) {
+  if (block_len < kInterfaceMinSize) {
+    return false;
+  }
+
+  Interface inf;
+  inf.link_type = Read16(block + 8);
+  inf.snaplen = Read32(block + 12);
+  inf.units_per_sec = kMicrosecondsPerSecond;
+  inf.ts_offset = 0;
+
+  size_t pos = 16;
+  const size_t end = block_len - sizeof(uint32_t);
+  while (pos + 4 <= end) {
+    const uint16_t code = Read16(block + pos);
+    const uint16_t len = Read16(block + pos + 2);
+    pos += 4;
+    if (code == kOptionEnd || pos + len > end) {
+      break;
+    }
+
+    if (code == kOptionTsResol && len == 1) {
+      const uint8_t resol = block[pos];
+      const uint8_t exp = resol & 0x7F;
+      if (resol & 0x80) {
+        if (exp > 63) {
+          return false;
+        }
+        inf.units_per_sec = static_cast<uint64_t>(1) << exp;
+      } else {
+        if (exp > 19) {
+          return false;
+        }
+        inf.units_per_sec = 1;
+        for (uint8_t i = 0; i < exp; ++i) {
+          inf.units_per_sec *= 10;
+        }
+      }
+    } else if (code == kOptionTsOffset && len == 8) {
+      uint64_t ts_offset;
+      memcpy(&ts_offset, block + pos, sizeof(ts_offset));
+      inf.ts_offset = static_cast<int64_t>(swapped_ ? bswap_64(ts_offset) : ts_offset);
+    }
+    pos += align4(len);
+  }
+
+  if (inf.units_per_sec == 0) {
+    return false;
+  }
+
+  interfaces_.push_back(inf);
+  return true;
+}
+}
+}
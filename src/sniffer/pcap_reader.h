@@ -0,0 +1,81 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <vector>
+
+#include <common/error.h>
+
+#include "sniffer/packet.h"
+
+namespace sniffer {
+namespace sniffer {
+
+// walks classic pcap and pcapng records laid out in memory, packet data points into the view
+class PcapReader {
+ public:
+  enum ReadResult { READ_OK, READ_NEED_MORE, READ_INVALID };
+
+  PcapReader();
+
+  // parses file header (pcap) or section header block (pcapng) at data
+  common::Error Init(const u_char* data, size_t size) WARN_UNUSED_RESULT;
+  // continues on new memory with parsed format state, offset restarts from 0
+  void SetData(const u_char* data, size_t size);
+
+  // READ_NEED_MORE if the rest of view holds only part of record
+  ReadResult Next(Packet* packet);
+
+  size_t GetOffset() const;  // consumed bytes of current view
+  size_t GetHeaderSize() const;
+  // link type of last returned packet, before first one header link type for classic pcap
+  // and first interface block in view for pcapng, -1 if none
+  int GetLinkType() const;
+  bool IsPcapng() const;
+
+  // classic pcap only, validates record header at data without consuming it
+  bool PeekRecord(const u_char* data, size_t size, size_t* record_size) const;
+
+ private:
+  struct Interface {
+    int link_type;
+    uint32_t snaplen;
+    uint64_t units_per_sec;  // timestamp resolution
+    int64_t ts_offset;       // seconds
+  };
+
+  uint16_t Read16(const u_char* data) const;
+  uint32_t Read32(const u_char* data) const;
+
+  ReadResult NextPcap(Packet* packet);
+  ReadResult NextPcapng(Packet* packet);
+  bool ReadSectionHeader(const u_char* block, uint32_t block_len);
+  bool ReadInterface(const u_char* block, uint32_t block_len);
+
+  const u_char* data_;
+  size_t size_;
+  size_t offset_;
+
+  bool pcapng_;
+  bool swapped_;
+  bool nsec_;
+  size_t header_size_;
+  uint32_t snaplen_;
+  int link_type_;
+  std::vector<Interface> interfaces_;
+};
+}
+}
@@ -0,0 +1,108 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "sniffer/replay_sniffer.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace sniffer {
+namespace sniffer {
+
+namespace {
+int64_t timeval2usec(const struct timeval& tv) {
+  return static_cast<int64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+}  // namespace
+
+ReplaySniffer::ReplaySniffer(const path_type& file_path, ISnifferObserver* observer, double speed)
+    : base_class(file_path, observer), speed_(speed), first_ts_(-1), start_(), replayed_(0) {}
+
+void ReplaySniffer::Run() {
+  first_ts_ = -1;
+  start_ = clock_t::now();
+  replayed_ = 0;
+  base_class::Run();
+
+  const int64_t elapsed = std::max<int64_t>(GetElapsedUsec(), 1);
+  const uint64_t replayed = replayed_;
+  INFO_LOG() << "Replay finished, file: " << GetPath().GetPath() << ", packets: " << replayed
+             << ", elapsed: " << elapsed / 1000 << " msec, rate: " << replayed * 1000000 / elapsed << " packets/sec";
+}
+
+common::Error ReplaySniffer::GetStats(CaptureStats* stats) {
+  if (!stats) {
+    return common::make_error_inval();
+  }
+
+  stats->received = replayed_;
+  stats->dropped = 0;
+  stats->if_dropped = 0;
+  return common::Error();
+}
+
+double ReplaySniffer::GetSpeed() const {
+  return speed_;
+}
+
+void ReplaySniffer::DeliverBatch(const Packet* packets, size_t count) {
+  if (speed_ <= 0) {
+    Replay(packets, count);
+    return;
+  }
+
+  // deliver what is already due in one go, sleep only in front of packet from the future
+  size_t begin = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const int64_t ts = timeval2usec(packets[i].header.ts);
+    if (first_ts_ == -1) {
+      first_ts_ = ts;
+    }
+
+    const int64_t due = static_cast<int64_t>(std::max<int64_t>(ts - first_ts_, 0) / speed_);
+    if (due <= GetElapsedUsec()) {
+      continue;
+    }
+
+    Replay(packets + begin, i - begin);
+    begin = i;
+    if (!WaitUntil(due)) {
+      return;
+    }
+  }
+  Replay(packets + begin, count - begin);
+}
+
+void ReplaySniffer::Replay(const Packet* packets, size_t count) {
+  base_class::DeliverBatch(packets, count);
+  replayed_ += count;
+}
+
+int64_t ReplaySniffer::GetElapsedUsec() const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(clock_t::now() - start_).count();
+}
+
+bool ReplaySniffer::WaitUntil(int64_t due_usec) {
+  while (!IsStopped()) {
+    const int64_t left = due_usec - GetElapsedUsec();
+    if (left <= 0) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(std::min<int64_t>(left, max_sleep_msec * 1000)));
+  }
+  return false;
+}
+}
+}
@@ -0,0 +1,58 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+#include "sniffer/file_sniffer.h"
+
+namespace sniffer {
+namespace sniffer {
+
+// re-emits capture file packets, paced by their timestamps scaled by speed, or unpaced when speed is 0
+class ReplaySniffer : public FileSniffer {
+ public:
+  typedef FileSniffer base_class;
+  typedef std::chrono::steady_clock clock_t;
+  enum { max_sleep_msec = 100 };  // granularity of Stop while waiting for next packet
+
+  ReplaySniffer(const path_type& file_path, ISnifferObserver* observer, double speed);
+
+  void Run() override;
+
+  // received counts replayed packets
+  virtual common::Error GetStats(CaptureStats* stats) override WARN_UNUSED_RESULT;
+
+  double GetSpeed() const;
+
+ protected:
+  virtual void DeliverBatch(const Packet* packets, size_t count) override;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ReplaySniffer);
+
+  void Replay(const Packet* packets, size_t count);
+  int64_t GetElapsedUsec() const;
+  bool WaitUntil(int64_t due_usec);  // false when stopped
+
+  const double speed_;
+  int64_t first_ts_;  // usec, capture time of first packet, -1 before it
+  clock_t::time_point start_;
+  std::atomic<uint64_t> replayed_;
+};
+}
+}
@@ -0,0 +1,325 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "sniffer/ring_sniffer.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <net/if.h>
+#include <net/if_arp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <linux/if_ether.h>
+#include <linux/filter.h>
+#include <linux/if_packet.h>
+
+#include <common/sprintf.h>
+
+#ifndef ARPHRD_IEEE80211_RADIOTAP
+#define ARPHRD_IEEE80211_RADIOTAP 803
+#endif
+
+namespace sniffer {
+namespace sniffer {
+
+namespace {
+
+int arphrd_to_dlt(unsigned short arphrd) {
+  switch (arphrd) {
+    case ARPHRD_ETHER:
+      return DLT_EN10MB;
+    case ARPHRD_IEEE80211:
+      return DLT_IEEE802_11;
+    case ARPHRD_IEEE80211_PRISM:
+      return DLT_PRISM_HEADER;
+    case ARPHRD_IEEE80211_RADIOTAP:
+      return DLT_IEEE802_11_RADIO;
+    default:
+      return -1;
+  }
+}
+
+common::Error make_socket_error(const char* func) {
+  return common::make_error(common::MemSPrintf("%s failed, errno: %d", func, errno));
+}
+}  // namespace
+
+RingSniffer::RingSniffer(const std::string& device,
+                         ISnifferObserver* observer,
+                         uint32_t block_size,
+                         uint32_t block_count,
+                         uint32_t retire_timeout,
+                         int read_timeout)
+    : base_class(observer),
+      device_(device),
+      mac_{0},
+      block_size_(block_size),
+      block_count_(block_count),
+      retire_timeout_(retire_timeout),
+      read_timeout_(read_timeout),
+      fanout_(false),
+      fanout_group_(0),
+      fanout_mode_(0),
+      fd_(INVALID_DESCRIPTOR),
+      ring_(NULL),
+      ring_size_(0),
+      link_type_(-1),
+      block_packets_(),
+      stats_(),
+      stopped_(false) {}
+
+RingSniffer::~RingSniffer() {}
+
+common::Error RingSniffer::Open() {
+  DCHECK(!IsValid());
+  if (device_.empty() || block_count_ == 0 || block_size_ == 0 || block_size_ % getpagesize() != 0) {
+    return common::make_error_inval();
+  }
+
+  const char* device_str = device_.c_str();
+  unsigned int ifindex = if_nametoindex(device_str);
+  if (ifindex == 0) {
+    return common::make_error(common::MemSPrintf("unknown device: %s", device_.c_str()));
+  }
+
+  int fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+  if (fd == INVALID_DESCRIPTOR) {
+    return make_socket_error("socket");
+  }
+
+  struct ifreq s;
+  memset(&s, 0, sizeof(s));
+  strncpy(s.ifr_name, device_str, IFNAMSIZ - 1);
+  if (ioctl(fd, SIOCGIFHWADDR, &s) != 0) {
+    common::Error err = make_socket_error("ioctl(SIOCGIFHWADDR)");
+    close(fd);
+    return err;
+  }
+
+  int link_type = arphrd_to_dlt(s.ifr_hwaddr.sa_family);
+  if (link_type == -1) {
+    close(fd);
+    return common::make_error(common::MemSPrintf("not supported hardware type: %d", s.ifr_hwaddr.sa_family));
+  }
+  memcpy(mac_, s.ifr_hwaddr.sa_data, sizeof(mac_));
+
+  int version = TPACKET_V3;
+  if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) != 0) {
+    common::Error err = make_socket_error("setsockopt(PACKET_VERSION)");
+    close(fd);
+    return err;
+  }
+
+  // frames are not fixed sized in V3, tp_frame_size only have to divide the block
+  struct tpacket_req3 req;
+  memset(&req, 0, sizeof(req));
+  req.tp_block_size = block_size_;
+  req.tp_block_nr = block_count_;
+  req.tp_frame_size = TPACKET_ALIGNMENT << 7;
+  req.tp_frame_nr = (block_size_ / req.tp_frame_size) * block_count_;
+  req.tp_retire_blk_tov = retire_timeout_;
+  req.tp_feature_req_word = 0;
+  if (setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) != 0) {
+    common::Error err = make_socket_error("setsockopt(PACKET_RX_RING)");
+    close(fd);
+    return err;
+  }
+
+  size_t ring_size = static_cast<size_t>(block_size_) * block_count_;
+  void* ring = mmap(NULL, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED, fd, 0);
+  if (ring == MAP_FAILED) {
+    common::Error err = make_socket_error("mmap");
+    close(fd);
+    return err;
+  }
+
+  struct sockaddr_ll ll;
+  memset(&ll, 0, sizeof(ll));
+  ll.sll_family = AF_PACKET;
+  ll.sll_protocol = htons(ETH_P_ALL);
+  ll.sll_ifindex = ifindex;
+  if (bind(fd, reinterpret_cast<struct sockaddr*>(&ll), sizeof(ll)) != 0) {
+    common::Error err = make_socket_error("bind");
+    munmap(ring, ring_size);
+    close(fd);
+    return err;
+  }
+
+  // must be set after bind, otherwise the group is joined on all interfaces
+  if (fanout_) {
+    int fanout_arg = fanout_group_ | (fanout_mode_ << 16);
+    if (setsockopt(fd, SOL_PACKET, PACKET_FANOUT, &fanout_arg, sizeof(fanout_arg)) != 0) {
+      common::Error err = make_socket_error("setsockopt(PACKET_FANOUT)");
+      munmap(ring, ring_size);
+      close(fd);
+      return err;
+    }
+  }
+
+  fd_ = fd;
+  ring_ = static_cast<uint8_t*>(ring);
+  ring_size_ = ring_size;
+  link_type_ = link_type;
+  BindDecoder(link_type);
+  return common::Error();
+}
+
+common::Error RingSniffer::Close() {
+  common::Error err = base_class::Close();
+  if (ring_) {
+    munmap(ring_, ring_size_);
+  }
+  if (fd_ != INVALID_DESCRIPTOR) {
+    close(fd_);
+  }
+  ring_ = NULL;
+  ring_size_ = 0;
+  fd_ = INVALID_DESCRIPTOR;
+  link_type_ = -1;
+  stats_ = CaptureStats();
+  return err;
+}
+
+void RingSniffer::Run() {
+  DCHECK(IsValid());
+
+  struct pollfd pfd;
+  memset(&pfd, 0, sizeof(pfd));
+  pfd.fd = fd_;
+  pfd.events = POLLIN | POLLERR;
+
+  uint32_t block_num = 0;
+  while (!stopped_) {
+    struct tpacket_block_desc* block =
+        reinterpret_cast<struct tpacket_block_desc*>(ring_ + static_cast<size_t>(block_num) * block_size_);
+    uint32_t status = __atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE);
+    if (!(status & TP_STATUS_USER)) {
+      int res = poll(&pfd, 1, read_timeout_);
+      if (res == ERROR_RESULT_VALUE && errno != EINTR) {
+        ERROR_LOG() << "Reading the packets error: " << errno;
+        break;
+      }
+      continue;
+    }
+
+    WalkBlock(block);
+    __atomic_store_n(&block->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+    block_num = (block_num + 1) % block_count_;
+  }
+}
+
+void RingSniffer::WalkBlock(struct tpacket_block_desc* block) {
+  // block stays owned by user space until released, so whole block goes to observer without copies
+  const uint32_t num_pkts = block->hdr.bh1.num_pkts;
+  block_packets_.resize(num_pkts);
+  uint8_t* ptr = reinterpret_cast<uint8_t*>(block) + block->hdr.bh1.offset_to_first_pkt;
+  for (uint32_t i = 0; i < num_pkts; ++i) {
+    struct tpacket3_hdr* ppd = reinterpret_cast<struct tpacket3_hdr*>(ptr);
+    Packet* packet = &block_packets_[i];
+    packet->header.ts.tv_sec = ppd->tp_sec;
+    packet->header.ts.tv_usec = ppd->tp_nsec / 1000;
+    packet->header.caplen = ppd->tp_snaplen;
+    packet->header.len = ppd->tp_len;
+    packet->data = ptr + ppd->tp_mac;
+    ptr += ppd->tp_next_offset;
+  }
+
+  HandlePackets(block_packets_.data(), num_pkts);
+}
+
+void RingSniffer::Stop() {
+  stopped_ = true;
+}
+
+bool RingSniffer::IsValid() const {
+  return ring_ != NULL;
+}
+
+int RingSniffer::GetLinkHeaderType() const {
+  return link_type_;
+}
+
+common::Error RingSniffer::SetFilter(const std::string& expression) {
+  DCHECK(IsValid());
+  // compile against dead handle of the same link type, then attach to the ring socket
+  pcap_t* dead = pcap_open_dead(link_type_, UINT16_MAX);
+  if (!dead) {
+    return common::make_error("pcap_open_dead failed");
+  }
+
+  struct bpf_program program;
+  if (pcap_compile(dead, &program, expression.c_str(), 1, PCAP_NETMASK_UNKNOWN) == -1) {
+    common::Error err = common::make_error(pcap_geterr(dead));
+    pcap_close(dead);
+    return err;
+  }
+  pcap_close(dead);
+
+  struct sock_fprog fprog;
+  fprog.len = program.bf_len;
+  fprog.filter = reinterpret_cast<struct sock_filter*>(program.bf_insns);
+  int res = setsockopt(fd_, SOL_SOCKET, SO_ATTACH_FILTER, &fprog, sizeof(fprog));
+  pcap_freecode(&program);
+  if (res != 0) {
+    return make_socket_error("setsockopt(SO_ATTACH_FILTER)");
+  }
+
+  return common::Error();
+}
+
+common::Error RingSniffer::GetStats(CaptureStats* stats) {
+  if (!stats) {
+    return common::make_error_inval();
+  }
+
+  DCHECK(IsValid());
+  // kernel resets counters on every read
+  struct tpacket_stats_v3 st;
+  socklen_t len = sizeof(st);
+  if (getsockopt(fd_, SOL_PACKET, PACKET_STATISTICS, &st, &len) != 0) {
+    return make_socket_error("getsockopt(PACKET_STATISTICS)");
+  }
+
+  stats_.received += st.tp_packets;
+  stats_.dropped += st.tp_drops;
+  *stats = stats_;
+  return common::Error();
+}
+
+void RingSniffer::SetFanout(uint16_t group, uint16_t mode) {
+  DCHECK(!IsValid());
+  fanout_ = true;
+  fanout_group_ = group;
+  fanout_mode_ = mode;
+}
+
+std::string RingSniffer::GetDevice() const {
+  return device_;
+}
+
+const unsigned char* RingSniffer::GetRawMacAddress() const {
+  DCHECK(IsValid());
+  return mac_;
+}
+
+std::string RingSniffer::GetMacAddress() const {
+  DCHECK(IsValid());
+  return mac2string(mac_);
+}
+}
+}
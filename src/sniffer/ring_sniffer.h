@@ -0,0 +1,89 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+
+#include "types.h"
+
+#include "sniffer/isniffer.h"
+
+struct tpacket_block_desc;
+
+namespace sniffer {
+namespace sniffer {
+
+// AF_PACKET TPACKET_V3 capture, frames are read in place from the mmaped block ring
+class RingSniffer : public ISniffer {
+ public:
+  typedef ISniffer base_class;
+  enum {
+    default_block_size = 1 << 22,  // must be a multiple of PAGE_SIZE
+    default_block_count = 64,
+    default_retire_timeout = 60,  // msec
+    default_read_timeout = 1000   // msec
+  };
+
+  RingSniffer(const std::string& device,
+              ISnifferObserver* observer,
+              uint32_t block_size = default_block_size,
+              uint32_t block_count = default_block_count,
+              uint32_t retire_timeout = default_retire_timeout,
+              int read_timeout = default_read_timeout);
+  virtual ~RingSniffer();
+
+  virtual common::Error Open() override WARN_UNUSED_RESULT;
+  virtual common::Error Close() override WARN_UNUSED_RESULT;
+
+  virtual void Run() override;
+  virtual void Stop() override;
+
+  virtual bool IsValid() const override;
+  virtual int GetLinkHeaderType() const override;
+  virtual common::Error SetFilter(const std::string& expression) override WARN_UNUSED_RESULT;
+  virtual common::Error GetStats(CaptureStats* stats) override WARN_UNUSED_RESULT;
+
+  // join PACKET_FANOUT group on Open, mode is one of PACKET_FANOUT_* with optional flags
+  void SetFanout(uint16_t group, uint16_t mode);
+
+  virtual std::string GetDevice() const override;
+
+  const unsigned char* GetRawMacAddress() const;
+  std::string GetMacAddress() const;
+
+ private:
+  void WalkBlock(struct tpacket_block_desc* block);
+
+  std::string device_;
+  mac_address_t mac_;
+  const uint32_t block_size_;
+  const uint32_t block_count_;
+  const uint32_t retire_timeout_;
+  const int read_timeout_;
+
+  bool fanout_;
+  uint16_t fanout_group_;
+  uint16_t fanout_mode_;
+
+  int fd_;
+  uint8_t* ring_;
+  size_t ring_size_;
+  int link_type_;
+  std::vector<Packet> block_packets_;
+  CaptureStats stats_;
+  std::atomic<bool> stopped_;
+};
+}
+}
@@ -14,11 +14,71 @@
 
 #include "types.h"
 
-#include <common/sprintf.h>
-
 namespace sniffer {
+namespace {
+const char kHexDigits[] = "0123456789abcdef";
+
+int hex_value(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  } else if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  } else if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+}  // namespace
+
+MacAddress::MacAddress() : value_(0) {}
+
+MacAddress::MacAddress(const unsigned char* bytes) : value_(0) {
+  for (size_t i = 0; i < SIZE_OF_MAC_ADDRESS; ++i) {
+    value_ = (value_ << 8) | bytes[i];
+  }
+}
+
+bool MacAddress::FromString(const std::string& text, MacAddress* mac) {
+  if (!mac || text.size() != SIZE_OF_MAC_ADDRESS * 3 - 1) {
+    return false;
+  }
+
+  uint64_t value = 0;
+  for (size_t i = 0; i < SIZE_OF_MAC_ADDRESS; ++i) {
+    const size_t pos = i * 3;
+    const int high = hex_value(text[pos]);
+    const int low = hex_value(text[pos + 1]);
+    if (high < 0 || low < 0) {
+      return false;
+    }
+    if (i + 1 < SIZE_OF_MAC_ADDRESS && text[pos + 2] != ':' && text[pos + 2] != '-') {
+      return false;
+    }
+    value = (value << 8) | (high << 4) | low;
+  }
+
+  mac->value_ = value;
+  return true;
+}
+
+void MacAddress::ToBytes(mac_address_t bytes) const {
+  for (size_t i = 0; i < SIZE_OF_MAC_ADDRESS; ++i) {
+    bytes[i] = value_ >> (8 * (SIZE_OF_MAC_ADDRESS - 1 - i));
+  }
+}
+
+std::string MacAddress::ToString() const {
+  char text[SIZE_OF_MAC_ADDRESS * 3];
+  for (size_t i = 0; i < SIZE_OF_MAC_ADDRESS; ++i) {
+    const unsigned octet = (value_ >> (8 * (SIZE_OF_MAC_ADDRESS - 1 - i))) & 0xFF;
+    text[i * 3] = kHexDigits[octet >> 4];
+    text[i * 3 + 1] = kHexDigits[octet & 0x0F];
+    text[i * 3 + 2] = ':';
+  }
+  return std::string(text, sizeof(text) - 1);
+}
 
 std::string mac2string(const mac_address_t mac) {
-  return common::MemSPrintf("%02x:%02x:%02x:%02x:%02x:%02x", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+  return MacAddress(mac).ToString();
 }
 }
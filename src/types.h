@@ -14,6 +14,10 @@
 
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
 #include <string>
 
 #define SIZE_OF_MAC_ADDRESS 6
@@ -23,5 +27,57 @@
 namespace sniffer {
 typedef unsigned char mac_address_t[SIZE_OF_MAC_ADDRESS];
 
+// 48 bit address packed into integer, first octet is most significant, formatted only on demand
+class MacAddress {
+ public:
+  MacAddress();
+  explicit MacAddress(const unsigned char* bytes);  // SIZE_OF_MAC_ADDRESS bytes in wire order
+
+  // "aa:bb:cc:dd:ee:ff" or "aa-bb-cc-dd-ee-ff", any case
+  static bool FromString(const std::string& text, MacAddress* mac);
+  static MacAddress FromValue(uint64_t value) {
+    MacAddress mac;
+    mac.value_ = value & UINT64_C(0xFFFFFFFFFFFF);
+    return mac;
+  }
+
+  uint64_t GetValue() const { return value_; }
+  void ToBytes(mac_address_t bytes) const;
+  std::string ToString() const;
+
+  bool IsZero() const { return value_ == 0; }
+  bool IsGroup() const { return value_ & (UINT64_C(0x01) << 40); }  // I/G bit of first octet
+  bool IsLocal() const { return value_ & (UINT64_C(0x02) << 40); }  // U/L bit, randomized addresses
+  bool IsBroadcast() const { return value_ == UINT64_C(0xFFFFFFFFFFFF); }
+
+ private:
+  uint64_t value_;
+};
+
+inline bool operator==(const MacAddress& left, const MacAddress& right) {
+  return left.GetValue() == right.GetValue();
+}
+
+inline bool operator!=(const MacAddress& left, const MacAddress& right) {
+  return !(left == right);
+}
+
+inline bool operator<(const MacAddress& left, const MacAddress& right) {
+  return left.GetValue() < right.GetValue();
+}
+
+struct MacAddressHash {
+  size_t operator()(const MacAddress& mac) const {
+    // vendor prefix is shared by many addresses, mix all bits into the low ones
+    uint64_t value = mac.GetValue() * UINT64_C(0x9E3779B97F4A7C15);
+    return static_cast<size_t>(value ^ (value >> 32));
+  }
+};
+
 std::string mac2string(const mac_address_t mac);
 }
+
+namespace std {
+template <>
+struct hash<sniffer::MacAddress> : public sniffer::MacAddressHash {};
+}
@@ -14,100 +14,187 @@
 
 #include "utils.h"
 
+#include <endian.h>
+#include <net/if_arp.h>
 #include <netinet/ip.h>
 
 #include <string.h>
 
-#include <array>
+#include <algorithm>
 
 #include <common/time.h>
 #include <common/sprintf.h>
 
+#include "mac_filter.h"
+#include "mac_select.h"
 #include "types.h"
+#include "pcap_packages/ieee80211_frame_table.h"
+#include "pcap_packages/ppi_header.h"
+#include "pcap_packages/prism_header.h"
 #include "pcap_packages/radiotap_header.h"
+#include "pcap_packages/radiotap_layout.h"
+#include "pcap_packages/sll2_header.h"
 
 namespace sniffer {
 
 namespace {
 
-const std::array<mac_address_t, 1> kFilteredMacs = {{BROADCAST_MAC}};
+const char* kParseResultNames[PARSE_RESULTS_COUNT] = {"ok",
+                                                      "invalid_input",
+                                                      "invalid_header_size",
+                                                      "invalid_framecontrol_size",
+                                                      "invalid_packet",
+                                                      "skipped"};
 
-bool need_to_skipped_mac(mac_address_t mac) {
-  if (ieee80211_broadcast_mac(mac)) {
-    return true;
+const size_t kRadioTapHeaderReserve = 128;  // room for extended presence bitmaps and fields
+
+// frame starts with 802.11 header, packet_len bytes captured
+PARSE_RESULT make_entry_from_ieee80211(const u_char* packet,
+                                       size_t packet_len,
+                                       const pcap_pkthdr* header,
+                                       int8_t ssi,
+                                       MacRecords* records) {
+  if (packet_len < sizeof(struct frame_control)) {
+    return PARSE_INVALID_FRAMECONTROL_SIZE;
   }
 
-  for (size_t i = 0; i < kFilteredMacs.size(); ++i) {
-    if (memcmp(kFilteredMacs[i], mac, SIZE_OF_MAC_ADDRESS) == 0) {
-      return true;
+  const ieee80211_frame_class& frame = ieee80211_classify(packet);
+  if (frame.action != IEEE80211_FRAME_KEEP) {
+    return frame.action == IEEE80211_FRAME_SKIP ? PARSE_SKIPPED_PACKET : PARSE_INVALID_PACKET;
+  }
+
+  const unsigned ds = ieee80211_ds_bits(packet);
+  if (packet_len < frame.min_length[ds]) {
+    return PARSE_INVALID_PACKET;
+  }
+
+  records->Append(MacAddress(packet + frame.source_offset[ds]), common::time::timeval2mstime(&header->ts), ssi);
+  return PARSE_OK;
+}
+}  // namespace
+
+const char* ParseResultToString(PARSE_RESULT result) {
+  if (result < 0 || result >= PARSE_RESULTS_COUNT) {
+    DNOTREACHED();
+    return "unknown";
+  }
+  return kParseResultNames[result];
+}
+
+ParseStats::ParseStats() : results() {}
+
+MacRecords::MacRecords() : count(0) {}
+
+size_t AppendSelectedEntries(const MacRecords& records, std::vector<EntryInfo>* entries, ParseStats* stats) {
+  uint16_t selected[MacRecords::capacity];
+  const size_t selected_count = SelectMacs(records.macs, records.count, GetMacSelectRules(), selected);
+
+  size_t appended = 0;
+  const MacFilter* filter = GetMacFilter();
+  for (size_t i = 0; i < selected_count; ++i) {
+    const size_t index = selected[i];
+    const MacAddress mac = MacAddress::FromValue(records.macs[index]);
+    if (filter && !filter->IsAllowed(mac)) {
+      continue;
     }
+    entries->push_back(EntryInfo(mac, records.timestamps[index], records.ssis[index]));
+    appended++;
   }
 
-  return false;
+  if (stats) {
+    const size_t rejected = records.count - appended;
+    stats->results[PARSE_OK] -= rejected;
+    stats->results[PARSE_SKIPPED_PACKET] += rejected;
+  }
+  return appended;
 }
+
+PARSE_RESULT MakeEntryFromRadioTap(const u_char* packet, const pcap_pkthdr* header, MacRecords* records) {
+  if (!packet || !header || !records) {
+    return PARSE_INVALID_INPUT;
+  }
+
+  // radiotap length and field set are driver dependent
+  size_t radio_len = 0;
+  const RadiotapLayout* layout = GetRadiotapLayout(packet, header->caplen, &radio_len);
+  if (!layout) {
+    return PARSE_INVALID_HEADER_SIZE;
+  }
+
+  int8_t ssi = UNKNOWN_SSI;
+  size_t ssi_offset;
+  if (GetRadiotapField(layout, radio_len, IEEE80211_RADIOTAP_DBM_ANTSIGNAL, &ssi_offset)) {
+    ssi = static_cast<int8_t>(packet[ssi_offset]);
+  }
+
+  return make_entry_from_ieee80211(packet + radio_len, header->caplen - radio_len, header, ssi, records);
 }
 
-PARSE_RESULT MakeEntryFromRadioTap(const u_char* packet, const pcap_pkthdr* header, EntryInfo* ent) {
-  if (!packet || !header || !ent) {
+PARSE_RESULT MakeEntryFromPrism(const u_char* packet, const pcap_pkthdr* header, MacRecords* records) {
+  if (!packet || !header || !records) {
     return PARSE_INVALID_INPUT;
   }
 
-  bpf_u_int32 packet_len = header->caplen;
-  if (packet_len < sizeof(struct radiotap_header)) {
+  if (header->caplen < sizeof(struct prism_header)) {
     return PARSE_INVALID_HEADER_SIZE;
   }
 
-  struct radiotap_header* radio = (struct radiotap_header*)packet;
-  packet += sizeof(struct radiotap_header);
-  packet_len -= sizeof(struct radiotap_header);
-  if (packet_len < sizeof(struct frame_control)) {
-    return PARSE_INVALID_FRAMECONTROL_SIZE;
+  // written by capturing host, so in host byte order
+  const struct prism_header* prism = reinterpret_cast<const struct prism_header*>(packet);
+  const uint32_t prism_len = prism->msglen;
+  if (prism_len < sizeof(struct prism_header) || prism_len > header->caplen) {
+    return PARSE_INVALID_HEADER_SIZE;
   }
 
-  struct frame_control* fc = (struct frame_control*)(packet);
-  mac_address_t mac = {0};
-  if (fc->type == TYPE_MNGMT || fc->type == TYPE_DATA) {
-    if (packet_len < sizeof(struct ieee80211header)) {
-      DNOTREACHED();
-      return PARSE_INVALID_PACKET;
-    }
+  int8_t ssi = UNKNOWN_SSI;
+  if (prism->signal.status == 0) {  // 0 - supplied
+    ssi = static_cast<int8_t>(prism->signal.data);
+  }
+  return make_entry_from_ieee80211(packet + prism_len, header->caplen - prism_len, header, ssi, records);
+}
 
-    struct ieee80211header* beac = (struct ieee80211header*)packet;
-    memcpy(mac, beac->addr2, sizeof(mac));
-  } else if (fc->type == TYPE_CNTRL) {
-    if (fc->subtype == SUBTYPE_CNTRL_ControlWrapper || fc->subtype == SUBTYPE_CNTRL_CTS ||
-        fc->subtype == SUBTYPE_CNTRL_ACK) {
-      return PARSE_SKIPPED_PACKET;
-    }
+PARSE_RESULT MakeEntryFromPpi(const u_char* packet, const pcap_pkthdr* header, MacRecords* records) {
+  if (!packet || !header || !records) {
+    return PARSE_INVALID_INPUT;
+  }
 
-    size_t offset_second_addr = sizeof(struct frame_control) + sizeof(uint16_t) + sizeof(mac);
-    if (packet_len < offset_second_addr) {
-      DNOTREACHED();
-      return PARSE_INVALID_PACKET;
-    }
+  if (header->caplen < sizeof(struct ppi_header)) {
+    return PARSE_INVALID_HEADER_SIZE;
+  }
 
-    const u_char* second_addr = packet + offset_second_addr;
-    memcpy(mac, second_addr, sizeof(mac));
-  } else if (fc->type == TYPE_RESERVED) {
-    return PARSE_INVALID_PACKET;
-  } else {
-    DNOTREACHED() << "Not handled frame control type: " << static_cast<int>(fc->type);
-    return PARSE_INVALID_PACKET;
+  const struct ppi_header* ppi = reinterpret_cast<const struct ppi_header*>(packet);
+  const size_t ppi_len = le16toh(ppi->pph_len);
+  if (ppi->pph_version != PPI_VERSION || ppi_len < sizeof(struct ppi_header) || ppi_len > header->caplen) {
+    return PARSE_INVALID_HEADER_SIZE;
   }
 
-  if (need_to_skipped_mac(mac)) {
-    // skipped_count++;
+  if (le32toh(ppi->pph_dlt) != DLT_IEEE802_11) {
     return PARSE_SKIPPED_PACKET;
   }
 
-  std::string source_mac = mac2string(mac);
-  common::time64_t ts_cap = common::time::timeval2mstime(&header->ts);
-  *ent = EntryInfo(source_mac, ts_cap, radio->wt_ssi_signal);  // timestamp in msec
-  return PARSE_OK;
+  // fields are type-length records, signal is in 802.11-Common one
+  int8_t ssi = UNKNOWN_SSI;
+  size_t pos = sizeof(struct ppi_header);
+  while (pos + sizeof(struct ppi_field_header) <= ppi_len) {
+    const struct ppi_field_header* field = reinterpret_cast<const struct ppi_field_header*>(packet + pos);
+    const size_t data_len = le16toh(field->pfh_datalen);
+    pos += sizeof(struct ppi_field_header);
+    if (pos + data_len > ppi_len) {
+      return PARSE_INVALID_HEADER_SIZE;
+    }
+
+    if (le16toh(field->pfh_type) == PPI_FIELD_80211_COMMON && data_len >= sizeof(struct ppi_80211_common)) {
+      const struct ppi_80211_common* common = reinterpret_cast<const struct ppi_80211_common*>(packet + pos);
+      ssi = common->dbm_antsignal;
+    }
+    pos += data_len;
+  }
+
+  return make_entry_from_ieee80211(packet + ppi_len, header->caplen - ppi_len, header, ssi, records);
 }
 
-PARSE_RESULT MakeEntryFromEthernet(const u_char* packet, const pcap_pkthdr* header, EntryInfo *ent) {
-  if (!packet || !header || !ent) {
+PARSE_RESULT MakeEntryFromEthernet(const u_char* packet, const pcap_pkthdr* header, MacRecords* records) {
+  if (!packet || !header || !records) {
     return PARSE_INVALID_INPUT;
   }
 
@@ -122,9 +209,106 @@ PARSE_RESULT MakeEntryFromEthernet(const u_char* packet, const pcap_pkthdr* head
     return PARSE_SKIPPED_PACKET;
   }
 
-  std::string source_mac = mac2string(ethernet_header->ether_shost);
-  common::time64_t ts_cap = common::time::timeval2mstime(&header->ts);
-  *ent = EntryInfo(source_mac, ts_cap);  // timestamp in msec
+  records->Append(MacAddress(ethernet_header->ether_shost), common::time::timeval2mstime(&header->ts), UNKNOWN_SSI);
   return PARSE_OK;
 }
+
+PARSE_RESULT MakeEntryFromLinuxSll2(const u_char* packet, const pcap_pkthdr* header, MacRecords* records) {
+  if (!packet || !header || !records) {
+    return PARSE_INVALID_INPUT;
+  }
+
+  if (header->caplen < sizeof(struct sll2_header)) {
+    return PARSE_INVALID_HEADER_SIZE;
+  }
+
+  // "any" device capture, source address is link-layer one of receiving interface type
+  const struct sll2_header* sll = reinterpret_cast<const struct sll2_header*>(packet);
+  if (ntohs(sll->sll2_protocol) != ETHERTYPE_IP || ntohs(sll->sll2_hatype) != ARPHRD_ETHER ||
+      sll->sll2_halen != SIZE_OF_MAC_ADDRESS) {
+    return PARSE_SKIPPED_PACKET;
+  }
+
+  records->Append(MacAddress(sll->sll2_addr), common::time::timeval2mstime(&header->ts), UNKNOWN_SSI);
+  return PARSE_OK;
+}
+
+namespace {
+// decoder of new link type: parser above, its row here and filter expression if kernel can prefilter it
+const LinkDecoder kLinkDecoders[] = {
+    {DLT_IEEE802_11_RADIO, "radiotap", ParseBatch<MakeEntryFromRadioTap>},
+    {DLT_PRISM_HEADER, "prism", ParseBatch<MakeEntryFromPrism>},
+    {DLT_PPI, "ppi", ParseBatch<MakeEntryFromPpi>},
+    {DLT_EN10MB, "ethernet", ParseBatch<MakeEntryFromEthernet>},
+    {DLT_LINUX_SLL2, "linux_sll2", ParseBatch<MakeEntryFromLinuxSll2>}};
+}  // namespace
+
+const LinkDecoder* FindLinkDecoder(int link_type) {
+  for (size_t i = 0; i < SIZEOFMASS(kLinkDecoders); ++i) {
+    if (kLinkDecoders[i].link_type == link_type) {
+      return &kLinkDecoders[i];
+    }
+  }
+
+  return NULL;
+}
+
+int GetHeaderSnaplen() {
+  const size_t radio = std::max(kRadioTapHeaderReserve, sizeof(struct prism_header)) + kIeee80211MaxHeaderLength;
+  const size_t ethernet = std::max(sizeof(struct ether_header), sizeof(struct sll2_header));
+  return static_cast<int>(std::max(radio, ethernet));
+}
+
+std::string MakeFilterExpression(int link_type, const std::vector<MacAddress>& deny_macs) {
+  std::string expression;
+  if (link_type == DLT_IEEE802_11_RADIO || link_type == DLT_PRISM_HEADER || link_type == DLT_PPI) {
+    // libpcap skips radio header for wlan[] offsets, first byte of frame control: subtype(4) type(2) version(2),
+    // second one: flags with ToDS and FromDS in low bits
+    // reserved type, ControlWrapper, CTS and ACK are dropped, then group or denied transmitter, which is
+    // addr4 for four address data frames and addr2 for every other kept frame, as in kIeee80211FrameClasses
+    const std::string four_address =
+        common::MemSPrintf("(wlan[0] & 0x0c = 0x%02x and wlan[1] & 0x03 = 0x03)", TYPE_DATA << 2);
+    std::string addr4_checks = common::MemSPrintf("wlan[%d] & 0x01 = 0", IEEE80211_ADDR4_OFFSET);
+    std::string addr2_checks = common::MemSPrintf("wlan[%d] & 0x01 = 0", IEEE80211_ADDR2_OFFSET);
+    for (size_t i = 0; i < deny_macs.size(); ++i) {
+      addr4_checks += " and not wlan addr4 " + deny_macs[i].ToString();
+      addr2_checks += " and not wlan addr2 " + deny_macs[i].ToString();
+    }
+    expression = common::MemSPrintf(
+        "wlan[0] & 0x0c != 0x0c and wlan[0] & 0xfc != 0x%02x and wlan[0] & 0xfc != 0x%02x and "
+        "wlan[0] & 0xfc != 0x%02x and ((%s and %s) or (not %s and %s))",
+        (SUBTYPE_CNTRL_ControlWrapper << 4) | (TYPE_CNTRL << 2), (SUBTYPE_CNTRL_CTS << 4) | (TYPE_CNTRL << 2),
+        (SUBTYPE_CNTRL_ACK << 4) | (TYPE_CNTRL << 2), four_address.c_str(), addr4_checks.c_str(),
+        four_address.c_str(), addr2_checks.c_str());
+  } else if (link_type == DLT_EN10MB) {
+    expression = "ether proto ip";
+    for (size_t i = 0; i < deny_macs.size(); ++i) {
+      expression += " and not ether src " + deny_macs[i].ToString();
+    }
+  } else if (link_type == DLT_LINUX_SLL2) {
+    expression = "ip";  // cooked header has no ethernet addresses to match
+  }
+
+  return expression;
+}
+
+size_t MakeEntries(int link_type,
+                   const sniffer::Packet* packets,
+                   size_t count,
+                   std::vector<EntryInfo>* entries,
+                   ParseStats* stats) {
+  if (!packets || !entries) {
+    return 0;
+  }
+
+  const LinkDecoder* decoder = FindLinkDecoder(link_type);
+  if (!decoder) {
+    if (stats) {
+      stats->results[PARSE_INVALID_INPUT] += count;
+    }
+    return 0;
+  }
+
+  return decoder->parse(packets, count, entries, stats);
+}
 }
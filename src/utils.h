@@ -16,8 +16,13 @@
 
 #include <pcap.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "entry_info.h"
 
+#include "sniffer/packet.h"
+
 namespace sniffer {
 
 enum PARSE_RESULT {
@@ -26,10 +31,93 @@ enum PARSE_RESULT {
   PARSE_INVALID_HEADER_SIZE,
   PARSE_INVALID_FRAMECONTROL_SIZE,
   PARSE_INVALID_PACKET,
-  PARSE_SKIPPED_PACKET
+  PARSE_SKIPPED_PACKET,
+  PARSE_RESULTS_COUNT
+};
+
+const char* ParseResultToString(PARSE_RESULT result);
+
+struct ParseStats {
+  ParseStats();
+
+  uint64_t results[PARSE_RESULTS_COUNT];  // indexed by PARSE_RESULT
+};
+
+// transmitters parsed from part of batch, kept in columns for vectorised address checks
+struct MacRecords {
+  enum { capacity = 256 };
+
+  MacRecords();
+
+  void Append(const MacAddress& mac, common::time64_t timestamp, int8_t ssi) {
+    macs[count] = mac.GetValue();
+    timestamps[count] = timestamp;
+    ssis[count] = ssi;
+    count++;
+  }
+
+  uint64_t macs[capacity];
+  common::time64_t timestamps[capacity];  // msec
+  int8_t ssis[capacity];
+  size_t count;
 };
 
-PARSE_RESULT MakeEntryFromRadioTap(const u_char* packet, const pcap_pkthdr* header, EntryInfo* ent);
+// packet parsers append one record on PARSE_OK, addresses are checked later for whole batch
+PARSE_RESULT MakeEntryFromRadioTap(const u_char* packet, const pcap_pkthdr* header, MacRecords* records);
+PARSE_RESULT MakeEntryFromPrism(const u_char* packet, const pcap_pkthdr* header, MacRecords* records);
+PARSE_RESULT MakeEntryFromPpi(const u_char* packet, const pcap_pkthdr* header, MacRecords* records);
+
+PARSE_RESULT MakeEntryFromEthernet(const u_char* packet, const pcap_pkthdr* header, MacRecords* records);
+PARSE_RESULT MakeEntryFromLinuxSll2(const u_char* packet, const pcap_pkthdr* header, MacRecords* records);
+
+// drops group, denied and filtered addresses, appends the rest, rejected are counted as PARSE_SKIPPED_PACKET
+size_t AppendSelectedEntries(const MacRecords& records, std::vector<EntryInfo>* entries, ParseStats* stats);
+
+typedef PARSE_RESULT (*parse_packet_t)(const u_char* packet, const pcap_pkthdr* header, MacRecords* records);
+typedef size_t (*parse_batch_t)(const sniffer::Packet* packets,
+                                size_t count,
+                                std::vector<EntryInfo>* entries,
+                                ParseStats* stats);
+
+// batch loop specialised for one packet parser, the parser is called directly, not through pointer
+template <parse_packet_t Parse>
+size_t ParseBatch(const sniffer::Packet* packets, size_t count, std::vector<EntryInfo>* entries, ParseStats* stats) {
+  size_t appended = 0;
+  MacRecords records;
+  for (size_t base = 0; base < count; base += MacRecords::capacity) {
+    const size_t chunk = std::min<size_t>(count - base, MacRecords::capacity);
+    records.count = 0;
+    for (size_t i = base; i < base + chunk; ++i) {
+      PARSE_RESULT res = Parse(packets[i].data, &packets[i].header, &records);
+      if (stats) {
+        stats->results[res]++;
+      }
+    }
+    appended += AppendSelectedEntries(records, entries, stats);
+  }
+  return appended;
+}
+
+struct LinkDecoder {
+  int link_type;  // DLT_*
+  const char* name;
+  parse_batch_t parse;
+};
+
+// registered decoder of link type, NULL if not supported
+const LinkDecoder* FindLinkDecoder(int link_type);
+
+// bytes from frame start enough for every parser above, radiotap header length is driver dependent
+int GetHeaderSnaplen();
+
+// pcap filter expression which drops in kernel what parsers above skip and deny_macs
+std::string MakeFilterExpression(int link_type, const std::vector<MacAddress>& deny_macs);
 
-PARSE_RESULT MakeEntryFromEthernet(const u_char* packet, const pcap_pkthdr* header, EntryInfo* ent);
+// parses batch of one link type, appends only PARSE_OK entries, returns count of appended
+// stats if not null accumulates result of every packet
+size_t MakeEntries(int link_type,
+                   const sniffer::Packet* packets,
+                   size_t count,
+                   std::vector<EntryInfo>* entries,
+                   ParseStats* stats = nullptr);
 }
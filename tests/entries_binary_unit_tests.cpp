@@ -0,0 +1,136 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "commands_info/entries_binary.h"
+
+namespace {
+std::string ToBase64(const std::string& bytes) {
+  static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  for (size_t i = 0; i < bytes.size(); i += 3) {
+    const size_t rest = bytes.size() - i;
+    uint32_t triple = static_cast<uint8_t>(bytes[i]) << 16;
+    if (rest > 1) {
+      triple |= static_cast<uint8_t>(bytes[i + 1]) << 8;
+    }
+    if (rest > 2) {
+      triple |= static_cast<uint8_t>(bytes[i + 2]);
+    }
+    out.push_back(alphabet[(triple >> 18) & 0x3F]);
+    out.push_back(alphabet[(triple >> 12) & 0x3F]);
+    out.push_back(rest > 1 ? alphabet[(triple >> 6) & 0x3F] : '=');
+    out.push_back(rest > 2 ? alphabet[triple & 0x3F] : '=');
+  }
+  return out;
+}
+
+common::Error Decode(const std::string& bytes, std::vector<sniffer::EntryInfo>* entries) {
+  const std::string encoded = ToBase64(bytes);
+  return sniffer::commands_info::DecodeEntriesBinary(encoded.data(), encoded.size(), entries);
+}
+
+// version 1, one iface "wlan0", one entry with given count and iface index
+std::string MakeSingleEntry(uint8_t count, uint8_t iface_index) {
+  std::string bytes("\x01\x01\x05wlan0\x01\x02", 10);  // version, ifaces, entry count, zigzag ts 1
+  bytes.append("\x00\x11\x22\x33\x44\x55", 6);           // mac
+  bytes.push_back(0);                                        // ts delta
+  bytes.push_back(static_cast<char>(-60));                   // ssi
+  bytes.push_back(count);
+  if (count != 1) {
+    bytes.append("\xc0\xd0", 2);  // ssi min, max
+  }
+  bytes.push_back(iface_index);
+  return bytes;
+}
+}  // namespace
+
+TEST(EntriesBinary, RoundTrip) {
+  std::vector<sniffer::EntryInfo> entries;
+  entries.push_back(sniffer::EntryInfo(sniffer::MacAddress::FromValue(UINT64_C(0x001122334455)), 1500000000000, -42));
+  entries.back().SetIface("wlan0");
+  // timestamps going back, aggregate and no iface
+  entries.push_back(sniffer::EntryInfo(sniffer::MacAddress::FromValue(UINT64_C(0xa0b0c0d0e0f0)), 1499999999000, -90));
+  entries.back().SetAggregate(300, -95, -71);
+  entries.push_back(sniffer::EntryInfo(sniffer::MacAddress::FromValue(UINT64_C(0x020000000001)), 1500000000000, 0));
+  entries.back().SetIface("wlan1");
+  entries.back().SetAggregate(UINT32_MAX, -128, 127);
+  entries.push_back(entries[0]);
+
+  std::string encoded;
+  sniffer::commands_info::EncodeEntriesBinary(entries.data(), entries.size(), &encoded);
+  std::vector<sniffer::EntryInfo> decoded;
+  common::Error err = sniffer::commands_info::DecodeEntriesBinary(encoded.data(), encoded.size(), &decoded);
+  ASSERT_FALSE(err);
+  EXPECT_EQ(entries, decoded);
+
+  encoded.clear();
+  sniffer::commands_info::EncodeEntriesBinary(NULL, 0, &encoded);
+  decoded = entries;
+  err = sniffer::commands_info::DecodeEntriesBinary(encoded.data(), encoded.size(), &decoded);
+  ASSERT_FALSE(err);
+  EXPECT_TRUE(decoded.empty());
+}
+
+TEST(EntriesBinary, ValidSingleEntry) {
+  std::vector<sniffer::EntryInfo> entries;
+  common::Error err = Decode(MakeSingleEntry(3, 1), &entries);
+  ASSERT_FALSE(err);
+  ASSERT_EQ(1u, entries.size());
+  EXPECT_EQ(UINT64_C(0x001122334455), entries[0].GetMacAddress().GetValue());
+  EXPECT_EQ(1, entries[0].GetTimestamp());
+  EXPECT_EQ(-60, entries[0].GetSSI());
+  EXPECT_EQ(3u, entries[0].GetCount());
+  EXPECT_EQ(-64, entries[0].GetMinSSI());
+  EXPECT_EQ(-48, entries[0].GetMaxSSI());
+  EXPECT_EQ("wlan0", entries[0].GetIface());
+}
+
+TEST(EntriesBinary, MalformedInputIsRejected) {
+  std::vector<sniffer::EntryInfo> entries;
+  const std::string valid = MakeSingleEntry(3, 1);
+  for (size_t len = 0; len < valid.size(); ++len) {
+    common::Error err = Decode(valid.substr(0, len), &entries);
+    EXPECT_TRUE(err) << "truncated to " << len;
+  }
+
+  common::Error err = Decode(valid + '\0', &entries);
+  EXPECT_TRUE(err) << "trailing byte";
+
+  std::string bytes = valid;
+  bytes[0] = 2;
+  err = Decode(bytes, &entries);
+  EXPECT_TRUE(err) << "version";
+
+  err = Decode(MakeSingleEntry(0, 1), &entries);
+  EXPECT_TRUE(err) << "zero count";
+
+  err = Decode(MakeSingleEntry(1, 2), &entries);
+  EXPECT_TRUE(err) << "iface index past table";
+
+  // entry count far above what remaining bytes can hold must fail before allocating
+  bytes = std::string("\x01\x00\xff\xff\xff\xff\x0f\x00", 8);
+  err = Decode(bytes, &entries);
+  EXPECT_TRUE(err) << "entry count";
+
+  const std::string not_base64 = "AQ*=";
+  err = sniffer::commands_info::DecodeEntriesBinary(not_base64.data(), not_base64.size(), &entries);
+  EXPECT_TRUE(err) << "alphabet";
+  err = sniffer::commands_info::DecodeEntriesBinary(not_base64.data(), 3, &entries);
+  EXPECT_TRUE(err) << "length";
+}
@@ -0,0 +1,108 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "client/entries_ring.h"
+
+namespace {
+// timestamp carries sequence number
+std::vector<sniffer::EntryInfo> MakeEntries(size_t first, size_t count) {
+  std::vector<sniffer::EntryInfo> entries;
+  for (size_t i = first; i < first + count; ++i) {
+    entries.push_back(sniffer::EntryInfo(sniffer::MacAddress::FromValue(i), i, -50));
+  }
+  return entries;
+}
+}  // namespace
+
+TEST(EntriesRing, CapacityIsPowerOfTwo) {
+  EXPECT_EQ(8u, sniffer::client::EntriesRing(5).GetCapacity());
+  EXPECT_EQ(8u, sniffer::client::EntriesRing(8).GetCapacity());
+  EXPECT_EQ(1u, sniffer::client::EntriesRing(0).GetCapacity());
+}
+
+TEST(EntriesRing, WrapKeepsOrder) {
+  sniffer::client::EntriesRing ring(8);
+  size_t next = 0;
+  size_t expected = 0;
+  // batch sizes not dividing capacity move indexes across the end of slots many times
+  for (size_t round = 0; round < 50; ++round) {
+    const size_t count = 1 + round % 7;
+    const std::vector<sniffer::EntryInfo> entries = MakeEntries(next, count);
+    ASSERT_EQ(count, ring.Push(entries.data(), entries.size()));
+    next += count;
+
+    std::vector<sniffer::EntryInfo> out;
+    ASSERT_EQ(count, ring.Pop(&out));
+    for (size_t i = 0; i < out.size(); ++i) {
+      EXPECT_EQ(static_cast<common::time64_t>(expected++), out[i].GetTimestamp());
+    }
+  }
+  EXPECT_EQ(0u, ring.GetDropped());
+  EXPECT_EQ(7u, ring.GetHighWater());  // consumer kept up, never more than one batch waiting
+}
+
+TEST(EntriesRing, OverflowDropsNewest) {
+  sniffer::client::EntriesRing ring(8);
+  const std::vector<sniffer::EntryInfo> entries = MakeEntries(0, 10);
+  EXPECT_EQ(6u, ring.Push(entries.data(), 6));
+  EXPECT_EQ(2u, ring.Push(entries.data() + 6, 4));
+  EXPECT_EQ(0u, ring.Push(entries.data(), 1));
+  EXPECT_EQ(3u, ring.GetDropped());
+  EXPECT_EQ(8u, ring.GetHighWater());
+
+  std::vector<sniffer::EntryInfo> out;
+  ASSERT_EQ(8u, ring.Pop(&out));
+  for (size_t i = 0; i < out.size(); ++i) {
+    EXPECT_EQ(entries[i], out[i]);
+  }
+
+  // freed slots are seen by producer again
+  EXPECT_EQ(2u, ring.Push(entries.data() + 8, 2));
+  out.clear();
+  ASSERT_EQ(2u, ring.Pop(&out));
+  EXPECT_EQ(entries[8], out[0]);
+  EXPECT_EQ(entries[9], out[1]);
+  EXPECT_EQ(0u, ring.Pop(&out));
+}
+
+TEST(EntriesRing, ProducerAndConsumerThreads) {
+  sniffer::client::EntriesRing ring(64);
+  const size_t total = 100000;
+  std::thread producer([&ring]() {
+    for (size_t i = 0; i < total; ++i) {
+      const std::vector<sniffer::EntryInfo> entry = MakeEntries(i, 1);
+      while (!ring.Push(entry.data(), 1)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::vector<sniffer::EntryInfo> out;
+  while (out.size() < total) {
+    if (!ring.Pop(&out)) {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+
+  for (size_t i = 0; i < out.size(); ++i) {
+    ASSERT_EQ(static_cast<common::time64_t>(i), out[i].GetTimestamp());
+  }
+  EXPECT_LE(ring.GetHighWater(), ring.GetCapacity());
+}
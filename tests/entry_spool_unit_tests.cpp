@@ -0,0 +1,191 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "client/entry_spool.h"
+
+namespace {
+const size_t kHeaderSize = 64;
+const size_t kRecordSize = 48;
+const size_t kSegmentSize = kHeaderSize + 4 * kRecordSize;  // four records per segment
+
+class EntrySpoolTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    char dir[] = "/tmp/entry_spool_testXXXXXX";
+    ASSERT_TRUE(mkdtemp(dir));
+    dir_ = dir;
+  }
+
+  void TearDown() override {
+    const std::vector<std::string> files = GetSegmentFiles();
+    for (size_t i = 0; i < files.size(); ++i) {
+      unlink(files[i].c_str());
+    }
+    rmdir(dir_.c_str());
+  }
+
+  std::vector<std::string> GetSegmentFiles() const {
+    std::vector<std::string> files;
+    DIR* dir = opendir(dir_.c_str());
+    if (!dir) {
+      return files;
+    }
+    while (struct dirent* ent = readdir(dir)) {
+      if (ent->d_name[0] != '.') {
+        files.push_back(dir_ + "/" + ent->d_name);
+      }
+    }
+    closedir(dir);
+    return files;
+  }
+
+  // timestamp carries sequence number
+  static std::vector<sniffer::EntryInfo> MakeEntries(size_t first, size_t count) {
+    std::vector<sniffer::EntryInfo> entries;
+    for (size_t i = first; i < first + count; ++i) {
+      sniffer::EntryInfo ent(sniffer::MacAddress::FromValue(0x001122000000 + i), i, -40 - i % 50);
+      ent.SetAggregate(1 + i % 3, -90, -30);
+      ent.SetIface(i % 2 ? "wlan0" : "");
+      entries.push_back(ent);
+    }
+    return entries;
+  }
+
+  // writes four records, overwrites bytes of third one and checks that recovery keeps first two and that
+  // fourth one is not revived once later appends reach its slot
+  void CheckTornRecovery(size_t offset_in_record, const char* bytes, size_t size) {
+    const std::vector<sniffer::EntryInfo> entries = MakeEntries(0, 4);
+    {
+      sniffer::client::EntrySpool spool(dir_, kSegmentSize, UINT64_MAX, 3600 * 1000);
+      ASSERT_FALSE(spool.Open());
+      ASSERT_FALSE(spool.Append(entries.data(), entries.size()));
+    }
+
+    const std::vector<std::string> files = GetSegmentFiles();
+    ASSERT_EQ(1u, files.size());
+    int fd = open(files[0].c_str(), O_RDWR);
+    ASSERT_NE(-1, fd);
+    ASSERT_EQ(static_cast<ssize_t>(size), pwrite(fd, bytes, size, kHeaderSize + 2 * kRecordSize + offset_in_record));
+    close(fd);
+
+    const std::vector<sniffer::EntryInfo> more = MakeEntries(100, 2);
+    {
+      sniffer::client::EntrySpool spool(dir_, kSegmentSize, UINT64_MAX, 3600 * 1000);
+      ASSERT_FALSE(spool.Open());
+      EXPECT_EQ(2u, spool.GetPendingCount());
+      ASSERT_FALSE(spool.Append(more.data(), 1));
+    }
+
+    sniffer::client::EntrySpool spool(dir_, kSegmentSize, UINT64_MAX, 3600 * 1000);
+    ASSERT_FALSE(spool.Open());
+    EXPECT_EQ(3u, spool.GetPendingCount());
+    ASSERT_FALSE(spool.Append(more.data() + 1, 1));  // fills slot of stale fourth record
+    std::vector<sniffer::EntryInfo> read;
+    ASSERT_EQ(4u, spool.Read(100, &read));
+    EXPECT_EQ(entries[0], read[0]);
+    EXPECT_EQ(entries[1], read[1]);
+    EXPECT_EQ(more[0], read[2]);
+    EXPECT_EQ(more[1], read[3]);
+  }
+
+  std::string dir_;
+};
+}  // namespace
+
+TEST_F(EntrySpoolTest, CursorSurvivesReopen) {
+  const std::vector<sniffer::EntryInfo> entries = MakeEntries(0, 10);
+  {
+    sniffer::client::EntrySpool spool(dir_, kSegmentSize, UINT64_MAX, 3600 * 1000);
+    ASSERT_FALSE(spool.Open());
+    ASSERT_FALSE(spool.Append(entries.data(), entries.size()));
+    EXPECT_EQ(10u, spool.GetPendingCount());
+
+    std::vector<sniffer::EntryInfo> read;
+    ASSERT_EQ(6u, spool.Read(6, &read));
+    EXPECT_EQ(std::vector<sniffer::EntryInfo>(entries.begin(), entries.begin() + 6), read);
+  }
+
+  sniffer::client::EntrySpool spool(dir_, kSegmentSize, UINT64_MAX, 3600 * 1000);
+  ASSERT_FALSE(spool.Open());
+  EXPECT_EQ(4u, spool.GetPendingCount());
+  EXPECT_EQ(2u, GetSegmentFiles().size());  // fully read first segment is removed
+
+  std::vector<sniffer::EntryInfo> read;
+  ASSERT_EQ(4u, spool.Read(100, &read));
+  EXPECT_EQ(std::vector<sniffer::EntryInfo>(entries.begin() + 6, entries.end()), read);
+  EXPECT_TRUE(spool.IsEmpty());
+}
+
+TEST_F(EntrySpoolTest, TornRecordEndsRecovery) {
+  // crash in the middle of third record, fourth one was written completely
+  const char garbage = 0x5a;
+  CheckTornRecovery(20, &garbage, 1);
+}
+
+TEST_F(EntrySpoolTest, TornRecordWithZeroChecksumEndsRecovery) {
+  // checksum bytes of third record did not land, rest of it did
+  const char zero_checksum[4] = {0, 0, 0, 0};
+  CheckTornRecovery(0, zero_checksum, sizeof(zero_checksum));
+}
+
+TEST_F(EntrySpoolTest, FreeSlotBeforeWrittenRecordEndsRecovery) {
+  // page with third record never reached disk, page with fourth one did
+  const std::string free_slot(kRecordSize, '\0');
+  CheckTornRecovery(0, free_slot.data(), free_slot.size());
+}
+
+TEST_F(EntrySpoolTest, SizeCapDropsOldestSegment) {
+  sniffer::client::EntrySpool spool(dir_, kSegmentSize, 2 * kSegmentSize, 3600 * 1000);
+  ASSERT_FALSE(spool.Open());
+  const std::vector<sniffer::EntryInfo> entries = MakeEntries(0, 12);
+  ASSERT_FALSE(spool.Append(entries.data(), entries.size()));
+  EXPECT_EQ(4u, spool.GetDroppedCount());
+  EXPECT_EQ(8u, spool.GetPendingCount());
+  EXPECT_EQ(2 * kSegmentSize, spool.GetSize());
+
+  std::vector<sniffer::EntryInfo> read;
+  ASSERT_EQ(8u, spool.Read(100, &read));
+  EXPECT_EQ(std::vector<sniffer::EntryInfo>(entries.begin() + 4, entries.end()), read);
+}
+
+TEST_F(EntrySpoolTest, InvalidSegmentIsDropped) {
+  const std::string path = dir_ + "/00000000000000000007.seg";
+  int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  ASSERT_NE(-1, fd);
+  const std::string garbage(kSegmentSize, 'x');
+  ASSERT_EQ(static_cast<ssize_t>(garbage.size()), write(fd, garbage.data(), garbage.size()));
+  close(fd);
+
+  sniffer::client::EntrySpool spool(dir_, kSegmentSize, UINT64_MAX, 3600 * 1000);
+  ASSERT_FALSE(spool.Open());
+  EXPECT_TRUE(spool.IsEmpty());
+  EXPECT_TRUE(GetSegmentFiles().empty());
+
+  // numbering continues after dropped segment
+  const std::vector<sniffer::EntryInfo> entries = MakeEntries(0, 1);
+  ASSERT_FALSE(spool.Append(entries.data(), entries.size()));
+  const std::vector<std::string> files = GetSegmentFiles();
+  ASSERT_EQ(1u, files.size());
+  EXPECT_EQ(dir_ + "/00000000000000000008.seg", files[0]);
+}
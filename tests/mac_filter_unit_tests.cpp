@@ -0,0 +1,224 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "mac_filter.h"
+
+namespace {
+const uint64_t kMacMask = UINT64_C(0xffffffffffff);
+
+// same mixing as MacSet, lets tests pick addresses landing on one slot
+uint64_t SetHash(uint64_t value) {
+  value *= UINT64_C(0x9E3779B97F4A7C15);
+  return value ^ (value >> 29);
+}
+
+std::vector<sniffer::MacAddress> RandomMacs(std::mt19937_64* random, size_t count) {
+  std::vector<sniffer::MacAddress> macs;
+  for (size_t i = 0; i < count; ++i) {
+    macs.push_back(sniffer::MacAddress::FromValue((*random)()));
+  }
+  return macs;
+}
+
+void CheckSet(const std::vector<sniffer::MacAddress>& macs, bool bloom, std::mt19937_64* random) {
+  std::set<uint64_t> members;
+  for (size_t i = 0; i < macs.size(); ++i) {
+    members.insert(macs[i].GetValue());
+  }
+
+  const sniffer::MacSet set(macs, bloom);
+  EXPECT_EQ(members.size(), set.GetSize());
+  EXPECT_EQ(bloom, set.HasBloom());
+  for (size_t i = 0; i < macs.size(); ++i) {
+    EXPECT_TRUE(set.Contains(macs[i])) << macs[i].ToString() << ", count: " << macs.size() << ", bloom: " << bloom;
+  }
+  for (size_t i = 0; i < 1000; ++i) {
+    const uint64_t value = (*random)() & kMacMask;
+    EXPECT_EQ(members.count(value) != 0, set.Contains(sniffer::MacAddress::FromValue(value)));
+  }
+}
+
+std::string WriteFilterFile(const std::string& content) {
+  char path[] = "/tmp/mac_filter_unit_tests_XXXXXX";
+  const int fd = mkstemp(path);
+  if (fd == -1) {
+    return std::string();
+  }
+  close(fd);
+  std::ofstream file(path);
+  file << content;
+  return path;
+}
+}  // namespace
+
+TEST(MacSet, ContainsEveryInsertedAcrossTableSizes) {
+  std::mt19937_64 random(7);
+  // table doubles at every power of two, check sizes on both sides of each step
+  for (size_t count = 0; count < 130; ++count) {
+    const std::vector<sniffer::MacAddress> macs = RandomMacs(&random, count);
+    CheckSet(macs, false, &random);
+    CheckSet(macs, true, &random);
+  }
+  CheckSet(RandomMacs(&random, 10000), false, &random);
+}
+
+TEST(MacSet, CollidingAddressesShareProbeChain) {
+  // smallest table has 16 slots, collect addresses with equal home slot
+  std::vector<sniffer::MacAddress> macs;
+  for (uint64_t value = 1; macs.size() < 8; ++value) {
+    if ((SetHash(value) & 15) == (SetHash(1) & 15)) {
+      macs.push_back(sniffer::MacAddress::FromValue(value));
+    }
+  }
+
+  const sniffer::MacSet set(macs, false);
+  ASSERT_EQ(macs.size(), set.GetSize());
+  for (size_t i = 0; i < macs.size(); ++i) {
+    EXPECT_TRUE(set.Contains(macs[i])) << macs[i].ToString();
+  }
+  // address with the same home slot not in the chain walks it to the empty slot
+  uint64_t absent = macs.back().GetValue() + 1;
+  while ((SetHash(absent) & 15) != (SetHash(1) & 15)) {
+    absent++;
+  }
+  EXPECT_FALSE(set.Contains(sniffer::MacAddress::FromValue(absent)));
+
+  // duplicates are stored once
+  std::vector<sniffer::MacAddress> duplicated(macs);
+  duplicated.insert(duplicated.end(), macs.begin(), macs.end());
+  EXPECT_EQ(macs.size(), sniffer::MacSet(duplicated, false).GetSize());
+}
+
+TEST(MacSet, BloomHasNoFalseNegatives) {
+  std::mt19937_64 random(11);
+  const std::vector<sniffer::MacAddress> macs = RandomMacs(&random, 100000);
+  const sniffer::MacSet set(macs, true);
+  size_t missing = 0;
+  for (size_t i = 0; i < macs.size(); ++i) {
+    missing += !set.Contains(macs[i]);
+  }
+  EXPECT_EQ(0u, missing);
+}
+
+TEST(MacFilter, AllowAndDenyModes) {
+  const sniffer::MacAddress listed = sniffer::MacAddress::FromValue(UINT64_C(0x001122334455));
+  const sniffer::MacAddress other = sniffer::MacAddress::FromValue(UINT64_C(0x001122334456));
+  const std::vector<sniffer::MacAddress> macs = {listed};
+  for (int bloom = 0; bloom < 2; ++bloom) {
+    const sniffer::MacFilter deny(sniffer::MacFilter::DENY_LIST, macs, bloom);
+    EXPECT_FALSE(deny.IsAllowed(listed));
+    EXPECT_TRUE(deny.IsAllowed(other));
+
+    const sniffer::MacFilter allow(sniffer::MacFilter::ALLOW_LIST, macs, bloom);
+    EXPECT_TRUE(allow.IsAllowed(listed));
+    EXPECT_FALSE(allow.IsAllowed(other));
+  }
+
+  // empty allow list lets nothing through, empty deny list everything
+  const std::vector<sniffer::MacAddress> none;
+  EXPECT_FALSE(sniffer::MacFilter(sniffer::MacFilter::ALLOW_LIST, none, false).IsAllowed(listed));
+  EXPECT_TRUE(sniffer::MacFilter(sniffer::MacFilter::DENY_LIST, none, false).IsAllowed(listed));
+}
+
+TEST(MacFilter, LoadFromFileSkipsCommentsAndInvalidLines) {
+  const std::string path = WriteFilterFile(
+      "# header\n"
+      "00:11:22:33:44:55\n"
+      "  AA-BB-CC-DD-EE-FF  # trailing comment\r\n"
+      "\n"
+      "not a mac\n"
+      "00:11:22:33:44\n");
+  ASSERT_FALSE(path.empty());
+
+  std::shared_ptr<const sniffer::MacFilter> filter;
+  common::Error err = sniffer::MacFilter::LoadFromFile(path, sniffer::MacFilter::DENY_LIST, true, &filter);
+  unlink(path.c_str());
+  ASSERT_FALSE(err);
+  ASSERT_TRUE(filter);
+  EXPECT_EQ(2u, filter->GetSize());
+  EXPECT_FALSE(filter->IsAllowed(sniffer::MacAddress::FromValue(UINT64_C(0x001122334455))));
+  EXPECT_FALSE(filter->IsAllowed(sniffer::MacAddress::FromValue(UINT64_C(0xaabbccddeeff))));
+  EXPECT_TRUE(filter->IsAllowed(sniffer::MacAddress::FromValue(UINT64_C(0x001122334456))));
+}
+
+TEST(MacFilter, ReaderSeesNewSnapshotAfterSet) {
+  const sniffer::MacAddress mac = sniffer::MacAddress::FromValue(UINT64_C(0x001122334455));
+  const std::vector<sniffer::MacAddress> macs = {mac};
+  std::shared_ptr<const sniffer::MacFilter> deny =
+      std::make_shared<const sniffer::MacFilter>(sniffer::MacFilter::DENY_LIST, macs, false);
+  std::shared_ptr<const sniffer::MacFilter> allow =
+      std::make_shared<const sniffer::MacFilter>(sniffer::MacFilter::ALLOW_LIST, macs, false);
+  const std::weak_ptr<const sniffer::MacFilter> deny_weak(deny);
+
+  sniffer::SetMacFilter(deny);
+  deny.reset();
+  const sniffer::MacFilter* before = nullptr;
+  std::thread([&before]() { before = sniffer::GetMacFilter(); }).join();
+  ASSERT_TRUE(before);
+  EXPECT_EQ(sniffer::MacFilter::DENY_LIST, before->GetMode());
+
+  // reader keeps its snapshot alive until it asks again
+  const sniffer::MacFilter* first = nullptr;
+  const sniffer::MacFilter* second = nullptr;
+  bool alive_after_swap = false;
+  bool read = false;
+  bool swapped = false;
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::thread reader([&]() {
+    first = sniffer::GetMacFilter();
+    std::unique_lock<std::mutex> lock(mutex);
+    read = true;
+    cond.notify_all();
+    cond.wait(lock, [&swapped]() { return swapped; });
+    alive_after_swap = !deny_weak.expired();
+    second = sniffer::GetMacFilter();
+  });
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [&read]() { return read; });
+  }
+  sniffer::SetMacFilter(allow);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    swapped = true;
+  }
+  cond.notify_all();
+  reader.join();
+
+  ASSERT_TRUE(first);
+  EXPECT_EQ(sniffer::MacFilter::DENY_LIST, first->GetMode());
+  EXPECT_TRUE(alive_after_swap);
+  EXPECT_EQ(allow.get(), second);
+  EXPECT_TRUE(second->IsAllowed(mac));
+  // thread locals released with their threads, last owner gone
+  EXPECT_TRUE(deny_weak.expired());
+
+  sniffer::SetMacFilter(nullptr);
+  EXPECT_EQ(nullptr, sniffer::GetMacFilter());
+}
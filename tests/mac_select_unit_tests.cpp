@@ -0,0 +1,80 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "mac_select.h"
+
+namespace {
+std::vector<uint16_t> SelectReference(const std::vector<uint64_t>& macs, const sniffer::MacSelectRules& rules) {
+  std::vector<uint16_t> selected;
+  for (size_t i = 0; i < macs.size(); ++i) {
+    bool drop = macs[i] & rules.reject_bits;
+    for (size_t j = 0; j < rules.deny_count; ++j) {
+      drop = drop || macs[i] == rules.deny[j];
+    }
+    if (!drop) {
+      selected.push_back(i);
+    }
+  }
+  return selected;
+}
+
+std::vector<uint16_t> SelectWith(const sniffer::detail::MacSelectKernel& kernel,
+                                 const std::vector<uint64_t>& macs,
+                                 const sniffer::MacSelectRules& rules) {
+  std::vector<uint16_t> selected(macs.size() + 1);
+  selected.resize(kernel.select(macs.data(), macs.size(), rules, selected.data()));
+  return selected;
+}
+}  // namespace
+
+TEST(MacSelect, KernelsMatchReference) {
+  std::mt19937_64 random(42);
+  sniffer::MacSelectRules rules;
+  rules.reject_bits |= MAC_LOCAL_BIT;
+  for (size_t j = 0; j < sniffer::MacSelectRules::max_deny; ++j) {
+    rules.deny[j] = random() & UINT64_C(0xfcffffffffff);
+  }
+  rules.deny_count = sniffer::MacSelectRules::max_deny;
+
+  const std::vector<sniffer::detail::MacSelectKernel> kernels = sniffer::detail::GetSupportedMacSelectKernels();
+  ASSERT_FALSE(kernels.empty());
+  // every tail length of sse and avx2 loops, group and local bits and denied macs in any lane
+  for (size_t count = 0; count < 70; ++count) {
+    std::vector<uint64_t> macs(count);
+    for (size_t i = 0; i < count; ++i) {
+      const uint64_t kind = random() % 4;
+      macs[i] = kind == 0 ? rules.deny[random() % rules.deny_count] : random() & UINT64_C(0xffffffffffff);
+    }
+    const std::vector<uint16_t> expected = SelectReference(macs, rules);
+    for (size_t k = 0; k < kernels.size(); ++k) {
+      EXPECT_EQ(expected, SelectWith(kernels[k], macs, rules)) << kernels[k].name << ", count: " << count;
+    }
+  }
+}
+
+TEST(MacSelect, NoDenyKeepsOnlyIndividualAddresses) {
+  sniffer::MacSelectRules rules;
+  const std::vector<uint64_t> macs = {UINT64_C(0x001122334455), UINT64_C(0x011122334455), UINT64_C(0x021122334455),
+                                      UINT64_C(0xffffffffffff), UINT64_C(0x001122334456)};
+  const std::vector<uint16_t> expected = {0, 2, 4};
+  const std::vector<sniffer::detail::MacSelectKernel> kernels = sniffer::detail::GetSupportedMacSelectKernels();
+  for (size_t k = 0; k < kernels.size(); ++k) {
+    EXPECT_EQ(expected, SelectWith(kernels[k], macs, rules)) << kernels[k].name;
+  }
+}
@@ -0,0 +1,118 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "pcap_packages/radiotap_layout.h"
+
+namespace {
+void PutLe16(size_t pos, uint16_t value, std::vector<uint8_t>* frame) {
+  (*frame)[pos] = value & 0xff;
+  (*frame)[pos + 1] = value >> 8;
+}
+
+void PutLe32(size_t pos, uint32_t value, std::vector<uint8_t>* frame) {
+  for (size_t i = 0; i < 4; ++i) {
+    (*frame)[pos + i] = value >> (i * 8);
+  }
+}
+
+// radiotap header of len bytes with given presence words, fields zeroed
+std::vector<uint8_t> MakeRadiotap(const std::vector<uint32_t>& present, uint16_t len) {
+  std::vector<uint8_t> frame(len);
+  PutLe16(2, len, &frame);
+  for (size_t i = 0; i < present.size(); ++i) {
+    PutLe32(4 + i * 4, present[i], &frame);
+  }
+  return frame;
+}
+
+size_t FieldOffset(const sniffer::RadiotapLayout* layout, size_t header_len, ieee80211_radiotap_presence field) {
+  size_t offset = 0;
+  if (!sniffer::GetRadiotapField(layout, header_len, field, &offset)) {
+    return 0;
+  }
+  return offset;
+}
+}  // namespace
+
+TEST(RadiotapLayout, FieldsAreAlignedAfterPresenceWords) {
+  const uint32_t present = 1u << IEEE80211_RADIOTAP_TSFT | 1u << IEEE80211_RADIOTAP_FLAGS |
+                           1u << IEEE80211_RADIOTAP_RATE | 1u << IEEE80211_RADIOTAP_CHANNEL |
+                           1u << IEEE80211_RADIOTAP_DBM_ANTSIGNAL;
+  const std::vector<uint8_t> frame = MakeRadiotap({present}, 23);
+  size_t header_len = 0;
+  const sniffer::RadiotapLayout* layout = sniffer::GetRadiotapLayout(frame.data(), frame.size(), &header_len);
+  ASSERT_TRUE(layout);
+  EXPECT_EQ(23u, header_len);
+  EXPECT_EQ(8u, FieldOffset(layout, header_len, IEEE80211_RADIOTAP_TSFT));
+  EXPECT_EQ(16u, FieldOffset(layout, header_len, IEEE80211_RADIOTAP_FLAGS));
+  EXPECT_EQ(17u, FieldOffset(layout, header_len, IEEE80211_RADIOTAP_RATE));
+  EXPECT_EQ(18u, FieldOffset(layout, header_len, IEEE80211_RADIOTAP_CHANNEL));
+  EXPECT_EQ(22u, FieldOffset(layout, header_len, IEEE80211_RADIOTAP_DBM_ANTSIGNAL));
+
+  size_t offset = 0;
+  EXPECT_FALSE(sniffer::GetRadiotapField(layout, header_len, IEEE80211_RADIOTAP_DBM_ANTNOISE, &offset));
+}
+
+TEST(RadiotapLayout, ExtendedPresenceWordsMoveFields) {
+  const uint32_t present = 1u << IEEE80211_RADIOTAP_TSFT | 1u << IEEE80211_RADIOTAP_DBM_ANTSIGNAL |
+                           1u << IEEE80211_RADIOTAP_EXT;
+  const std::vector<uint8_t> frame = MakeRadiotap({present, 1u << IEEE80211_RADIOTAP_EXT, 0}, 32);
+  size_t header_len = 0;
+  const sniffer::RadiotapLayout* layout = sniffer::GetRadiotapLayout(frame.data(), frame.size(), &header_len);
+  ASSERT_TRUE(layout);
+  EXPECT_EQ(16u, FieldOffset(layout, header_len, IEEE80211_RADIOTAP_TSFT));
+  EXPECT_EQ(24u, FieldOffset(layout, header_len, IEEE80211_RADIOTAP_DBM_ANTSIGNAL));
+
+  // same first word with one extended word less is a different layout, not a stale cache entry
+  const std::vector<uint8_t> shorter = MakeRadiotap({present, 0}, 24);
+  layout = sniffer::GetRadiotapLayout(shorter.data(), shorter.size(), &header_len);
+  ASSERT_TRUE(layout);
+  EXPECT_EQ(16u, FieldOffset(layout, header_len, IEEE80211_RADIOTAP_TSFT));
+  EXPECT_EQ(0u, FieldOffset(layout, header_len, IEEE80211_RADIOTAP_DBM_ANTSIGNAL));  // past header end
+
+  const std::vector<uint8_t> no_tsft = MakeRadiotap({1u << IEEE80211_RADIOTAP_DBM_ANTSIGNAL}, 9);
+  layout = sniffer::GetRadiotapLayout(no_tsft.data(), no_tsft.size(), &header_len);
+  ASSERT_TRUE(layout);
+  EXPECT_EQ(8u, FieldOffset(layout, header_len, IEEE80211_RADIOTAP_DBM_ANTSIGNAL));
+}
+
+TEST(RadiotapLayout, MalformedHeadersAreRejected) {
+  size_t header_len = 0;
+  const uint32_t present = 1u << IEEE80211_RADIOTAP_DBM_ANTSIGNAL;
+
+  std::vector<uint8_t> frame = MakeRadiotap({present}, 9);
+  EXPECT_FALSE(sniffer::GetRadiotapLayout(frame.data(), 7, &header_len));  // shorter than fixed header
+  EXPECT_FALSE(sniffer::GetRadiotapLayout(frame.data(), 8, &header_len));  // it_len past caplen
+
+  frame[0] = 1;  // version
+  EXPECT_FALSE(sniffer::GetRadiotapLayout(frame.data(), frame.size(), &header_len));
+
+  frame = MakeRadiotap({present}, 9);
+  PutLe16(2, 4, &frame);  // it_len below fixed header
+  EXPECT_FALSE(sniffer::GetRadiotapLayout(frame.data(), frame.size(), &header_len));
+
+  // extended presence chain runs past it_len
+  frame = MakeRadiotap({present | 1u << IEEE80211_RADIOTAP_EXT, 1u << IEEE80211_RADIOTAP_EXT}, 12);
+  EXPECT_FALSE(sniffer::GetRadiotapLayout(frame.data(), frame.size(), &header_len));
+
+  // chain longer than supported
+  std::vector<uint32_t> words(IEEE80211_RADIOTAP_MAX_PRESENT_WORDS + 2, 1u << IEEE80211_RADIOTAP_EXT);
+  words.back() = 0;
+  frame = MakeRadiotap(words, 4 + words.size() * 4);
+  EXPECT_FALSE(sniffer::GetRadiotapLayout(frame.data(), frame.size(), &header_len));
+}
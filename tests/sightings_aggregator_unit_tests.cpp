@@ -0,0 +1,127 @@
+/*  Copyright (C) 2014-2018 FastoGT. All right reserved.
+    This file is part of sniffer.
+    sniffer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    sniffer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with sniffer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "client/sightings_aggregator.h"
+
+namespace {
+const uint64_t kMac = UINT64_C(0x001122334455);
+
+sniffer::EntryInfo MakeEntry(uint64_t mac, common::time64_t ts, int8_t ssi, const std::string& iface = "wlan0") {
+  sniffer::EntryInfo entry(sniffer::MacAddress::FromValue(mac), ts, ssi);
+  entry.SetIface(iface);
+  return entry;
+}
+
+// mean of one transmitter seen with given signals within a single second
+sniffer::EntryInfo Aggregate(const std::vector<int8_t>& ssis) {
+  sniffer::client::SightingsAggregator aggregator;
+  for (size_t i = 0; i < ssis.size(); ++i) {
+    aggregator.Add(MakeEntry(kMac, 5000 + i, ssis[i]));
+  }
+  std::vector<sniffer::EntryInfo> entries;
+  aggregator.TakeAll(&entries);
+  return entries.size() == 1 ? entries[0] : sniffer::EntryInfo();
+}
+}  // namespace
+
+TEST(SightingsAggregator, MeanRoundsHalfAwayFromZero) {
+  EXPECT_EQ(-6, Aggregate({-5, -6}).GetSSI());      // -5.5
+  EXPECT_EQ(-4, Aggregate({-3, -4}).GetSSI());      // -3.5
+  EXPECT_EQ(-4, Aggregate({-4, -4, -5}).GetSSI());  // -4.33
+  EXPECT_EQ(-5, Aggregate({-4, -5, -5}).GetSSI());  // -4.67
+  EXPECT_EQ(-2, Aggregate({-1, -2}).GetSSI());      // -1.5
+  EXPECT_EQ(-128, Aggregate({-128, -128}).GetSSI());
+  EXPECT_EQ(4, Aggregate({3, 4}).GetSSI());  // 3.5, relative signal
+  EXPECT_EQ(3, Aggregate({3, 3, 4}).GetSSI());
+}
+
+TEST(SightingsAggregator, UnknownSignalCountedButNotAveraged) {
+  const sniffer::EntryInfo mixed = Aggregate({-50, UNKNOWN_SSI, -61});
+  EXPECT_EQ(3u, mixed.GetCount());
+  EXPECT_EQ(-56, mixed.GetSSI());  // -55.5
+  EXPECT_EQ(-61, mixed.GetMinSSI());
+  EXPECT_EQ(-50, mixed.GetMaxSSI());
+
+  const sniffer::EntryInfo unknown = Aggregate({UNKNOWN_SSI, UNKNOWN_SSI});
+  EXPECT_EQ(2u, unknown.GetCount());
+  EXPECT_EQ(UNKNOWN_SSI, unknown.GetSSI());
+}
+
+TEST(SightingsAggregator, SecondClosesTwoSecondsAfterItsStart) {
+  sniffer::client::SightingsAggregator aggregator;
+  std::vector<sniffer::EntryInfo> entries;
+  aggregator.Add(MakeEntry(kMac, 10500, -40));
+  aggregator.Add(MakeEntry(kMac, 11999, -40));
+  aggregator.TakeClosed(&entries);
+  EXPECT_TRUE(entries.empty());
+
+  // newest reaches second + 1000 + close_delay_msec
+  aggregator.Add(MakeEntry(kMac, 12000, -40));
+  aggregator.TakeClosed(&entries);
+  ASSERT_EQ(1u, entries.size());
+  EXPECT_EQ(10000, entries[0].GetTimestamp());
+
+  // late frame reopens closed second as a new entry, newer seconds stay open
+  entries.clear();
+  aggregator.Add(MakeEntry(kMac, 10999, -40));
+  aggregator.TakeClosed(&entries);
+  ASSERT_EQ(1u, entries.size());
+  EXPECT_EQ(10000, entries[0].GetTimestamp());
+  EXPECT_FALSE(aggregator.IsEmpty());
+
+  entries.clear();
+  aggregator.TakeAll(&entries);
+  ASSERT_EQ(2u, entries.size());
+  EXPECT_EQ(11000, entries[0].GetTimestamp());
+  EXPECT_EQ(12000, entries[1].GetTimestamp());
+  EXPECT_TRUE(aggregator.IsEmpty());
+  EXPECT_EQ(4u, aggregator.GetAddedCount());
+}
+
+TEST(SightingsAggregator, SameMacOnTwoIfacesKeptApart) {
+  sniffer::client::SightingsAggregator aggregator;
+  const uint64_t broadcast = UINT64_C(0xffffffffffff);  // all address bits set, iface index above them
+  aggregator.Add(MakeEntry(broadcast, 1100, -30, "wlan0"));
+  aggregator.Add(MakeEntry(broadcast, 1200, -70, "wlan1"));
+  aggregator.Add(MakeEntry(broadcast, 1300, -32, "wlan0"));
+  aggregator.Add(MakeEntry(kMac, 1400, -50, "wlan1"));
+
+  std::vector<sniffer::EntryInfo> entries;
+  aggregator.TakeAll(&entries);
+  ASSERT_EQ(3u, entries.size());
+  size_t found = 0;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const sniffer::EntryInfo& entry = entries[i];
+    EXPECT_EQ(1000, entry.GetTimestamp());
+    if (entry.GetMacAddress().GetValue() == broadcast && entry.GetIface() == "wlan0") {
+      EXPECT_EQ(2u, entry.GetCount());
+      EXPECT_EQ(-31, entry.GetSSI());
+      found++;
+    } else if (entry.GetMacAddress().GetValue() == broadcast && entry.GetIface() == "wlan1") {
+      EXPECT_EQ(1u, entry.GetCount());
+      EXPECT_EQ(-70, entry.GetSSI());
+      found++;
+    } else if (entry.GetMacAddress().GetValue() == kMac && entry.GetIface() == "wlan1") {
+      EXPECT_EQ(1u, entry.GetCount());
+      EXPECT_EQ(-50, entry.GetSSI());
+      found++;
+    }
+  }
+  EXPECT_EQ(3u, found);
+}